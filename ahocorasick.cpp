@@ -0,0 +1,80 @@
+#include "ahocorasick.hpp"
+
+using namespace llvm;
+
+
+/**
+ Register a pattern. Takes effect with the next call to `compile`.
+
+ @param pattern The string to search for.
+ @param value The value reported by `matches` when the pattern is found.
+ */
+void AhoCorasick::addPattern(StringRef pattern, unsigned value) {
+    patterns.push_back(pattern.str());
+    values.push_back(value);
+}
+
+
+/**
+ Build the transition table from the registered patterns. Can be called again after more
+ patterns have been added.
+ */
+void AhoCorasick::compile() {
+    // every character used in a pattern gets its own column, all others share column 0
+    std::fill(std::begin(char_class), std::end(char_class), 0);
+    class_count = 1;
+    for (const std::string& pattern: patterns)
+        for (char c: pattern)
+            if (char_class[static_cast<unsigned char>(c)] == 0)
+                char_class[static_cast<unsigned char>(c)] = class_count++;
+
+    // build the trie of the patterns
+    std::vector<std::map<unsigned, unsigned>> trie(1);
+    outputs.assign(1, std::vector<unsigned>());
+    for (std::size_t idx = 0; idx < patterns.size(); ++idx) {
+        unsigned state = 0;
+        for (char c: patterns[idx]) {
+            unsigned cls = char_class[static_cast<unsigned char>(c)];
+            auto child = trie[state].find(cls);
+            if (child == trie[state].end()) {
+                trie.push_back(std::map<unsigned, unsigned>());
+                outputs.push_back(std::vector<unsigned>());
+                child = trie[state].insert(std::make_pair(cls, static_cast<unsigned>(trie.size() - 1))).first;
+            }
+            state = child->second;
+        }
+        outputs[state].push_back(values[idx]);
+    }
+
+    // turn the trie into a DFA: missing edges follow the failure links, which are resolved in
+    // breadth-first order so the transitions of shorter prefixes are always complete already
+    transitions.assign(trie.size() * class_count, 0);
+    std::vector<unsigned> failure(trie.size(), 0);
+    std::queue<unsigned> pending {};
+
+    for (const auto& edge: trie[0]) {
+        transitions[edge.first] = edge.second;
+        pending.push(edge.second);
+    }
+
+    while (!pending.empty()) {
+        unsigned state = pending.front();
+        pending.pop();
+
+        // a state also reports the patterns of its longest proper suffix
+        const std::vector<unsigned>& inherited = outputs[failure[state]];
+        outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+
+        for (unsigned cls = 0; cls < class_count; ++cls) {
+            auto child = trie[state].find(cls);
+            unsigned fallback = transitions[failure[state] * class_count + cls];
+            if (child == trie[state].end())
+                transitions[state * class_count + cls] = fallback;
+            else {
+                failure[child->second] = fallback;
+                transitions[state * class_count + cls] = child->second;
+                pending.push(child->second);
+            }
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef ahocorasick_hpp
+#define ahocorasick_hpp
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+
+/**
+ Aho-Corasick automaton for finding any number of patterns in a single pass over a text.
+ The patterns are added first and compiled into a deterministic automaton afterwards, so
+ every input character costs exactly one table lookup. Characters that occur in no pattern
+ share a single column of the transition table.
+ */
+class AhoCorasick {
+public:
+    void addPattern(llvm::StringRef pattern, unsigned value);
+    void compile();
+
+    /// The state before any character has been read.
+    unsigned start() const { return 0; }
+
+    /// The state after reading `c` in state `state`.
+    unsigned next(unsigned state, char c) const {
+        return transitions[state * class_count + char_class[static_cast<unsigned char>(c)]];
+    }
+
+    /// The values of all patterns ending at the last character read to reach `state`.
+    const std::vector<unsigned>& matches(unsigned state) const { return outputs[state]; }
+
+private:
+    std::vector<std::string> patterns;
+    std::vector<unsigned> values;
+
+    unsigned char char_class[256] = {};
+    unsigned class_count = 1;
+    std::vector<unsigned> transitions;
+    std::vector<std::vector<unsigned>> outputs;
+};
+
+#endif /* ahocorasick_hpp */
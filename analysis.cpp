@@ -5,85 +5,191 @@ using namespace llvm;
 /***************************************** Sender Analysis *****************************************/
 
 /**
+ A step of the search for the store of a sent value: either the next value to search from, or a
+ store of a constant that has been found.
+ */
+struct SearchStep {
+    Value* next;
+    StoreInst* hit;
+};
+
+
+/**
+ Get the steps the search takes from a value: through bitcasts, loads, stores, memcpys and GEPs,
+ until a store of a constant is found. The steps are in the order they are tried.
+
  Things to improve:
- - do we need the `prev` argument?
  - recognition and handling of PHI nodes -> there would be only a single immediate use case for it
  - recognition and handling of "unwrap" operations (unwrapping result and option types) -> necessary?
  - there are some operations we are currently not equipped to handle
  - trace senders that send optionals/results?
- - get some structure into the function
- - how to save the values?
- */
-StoreInst* getRelevantStoreFromValue(Value* val, Value* prev, std::unordered_set<Value*>* been_there) {
-    // this set keeps book about the statements we have seen so far to detect loops
-    if (been_there->find(val) == been_there->end())
-        been_there->insert(val);
-    else
-        return nullptr;
-
-    // emit information about detected phi nodes for debugging purposes
-    if (PHINode* pn = dyn_cast<PHINode>(val))
-        // this is just a side note since PHI node encounters are really rare (only one in early tests)
-        outs() << "[DEBUG] Found a phi node!\n    " << pn->getModule()->getName() << "\n";
 
-    if (BitCastInst* bi = dyn_cast<BitCastInst>(val)) {
-        StoreInst* deep_store_inst = getRelevantStoreFromValue(bi->getOperand(0), val, been_there);
-        if (deep_store_inst != nullptr)
-            return deep_store_inst;
-    }
-    if (LoadInst* li = dyn_cast<LoadInst>(val)) {
-        StoreInst* deep_store_inst = getRelevantStoreFromValue(li->getPointerOperand(), val, been_there);
-        if (deep_store_inst != nullptr)
-            return deep_store_inst;
-    }
+ @param val The value to search from.
+ @param steps Receives the steps.
+ */
+static void getSearchSteps(Value* val, std::vector<SearchStep>& steps) {
+    if (BitCastInst* bi = dyn_cast<BitCastInst>(val))
+        steps.push_back(SearchStep {bi->getOperand(0), nullptr});
+    if (LoadInst* li = dyn_cast<LoadInst>(val))
+        steps.push_back(SearchStep {li->getPointerOperand(), nullptr});
 
     for (User* u: val->users()) {
-        if (LoadInst* li = dyn_cast<LoadInst>(u)) {
-            StoreInst* deep_store_inst = getRelevantStoreFromValue(li->getPointerOperand(), val, been_there);
-            if (deep_store_inst != nullptr)
-                return deep_store_inst;
-        }
-        if (StoreInst* si = dyn_cast<StoreInst>(u)) {
+        if (LoadInst* li = dyn_cast<LoadInst>(u))
+            steps.push_back(SearchStep {li->getPointerOperand(), nullptr});
+        else if (StoreInst* si = dyn_cast<StoreInst>(u)) {
             // we are done after having found a constant assignment
             if (isa<ConstantInt>(si->getValueOperand()))
-                return si;
-            else {
-                StoreInst* deep_store_inst = getRelevantStoreFromValue(si->getValueOperand(), val, been_there);
-                if (deep_store_inst != nullptr)
-                    return deep_store_inst;
-            }
+                steps.push_back(SearchStep {nullptr, si});
+            else
+                steps.push_back(SearchStep {si->getValueOperand(), nullptr});
         }
-        if (BitCastInst* bi = dyn_cast<BitCastInst>(u)) {
+        else if (BitCastInst* bi = dyn_cast<BitCastInst>(u)) {
             // the found use is either result of a bitcast or used in one
-            StoreInst* deep_store_inst;
             if (bi->getOperand(0) == val)
-                deep_store_inst = getRelevantStoreFromValue(bi, val, been_there);
+                steps.push_back(SearchStep {bi, nullptr});
             else
-                deep_store_inst = getRelevantStoreFromValue(bi->getOperand(0), val, been_there);
-
-            if (deep_store_inst != nullptr)
-                return deep_store_inst;
+                steps.push_back(SearchStep {bi->getOperand(0), nullptr});
         }
-        if (AllocaInst* ai = dyn_cast<AllocaInst>(u))
-            continue;
-        if (MemTransferInst* mi = dyn_cast<MemTransferInst>(u)) {
-            StoreInst* deep_store_inst;
+        else if (MemTransferInst* mi = dyn_cast<MemTransferInst>(u)) {
             if (mi->getRawDest() == val)
-                deep_store_inst = getRelevantStoreFromValue(mi->getRawSource(), val, been_there);
+                steps.push_back(SearchStep {mi->getRawSource(), nullptr});
+            else
+                steps.push_back(SearchStep {mi->getRawDest(), nullptr});
+        }
+        else if (GetElementPtrInst* gi = dyn_cast<GetElementPtrInst>(u))
+            steps.push_back(SearchStep {gi, nullptr});
+    }
+}
+
+
+// a value on the stack of the search
+struct SearchFrame {
+    Value* val;
+    std::vector<SearchStep> steps;
+    std::size_t next_step;
+    unsigned index;         ///< The position of the value in the search order.
+    unsigned low;           ///< The lowest index reachable from the value that is still on the stack.
+    bool exact;             ///< No store is reachable from the value, whichever search it is entered from.
+};
+
+
+/**
+ Find the first store of a constant reachable from a value, searching depth-first in the order of
+ `getSearchSteps`. The search uses an explicit stack instead of recursion, so deep chains cannot
+ overflow the call stack, and ends at the first store found.
+
+ The cache remembers the result of every searched start value, and every value no store is
+ reachable from at all; later searches (of other sends) skip these values instead of walking
+ them again. The store found from any other value is not remembered: it depends on the values
+ already visited, on a cycle (e.g. memcpys in both directions) on where the cycle is entered. A
+ value is only known to reach no store once its cycle is complete, and only if no value it
+ skipped as visited could reach one. The results are the same as those of a search without cache.
+
+ Every value entered is a step of the budget, the size of the stack is its depth. If the budget
+ runs out, the search is abandoned; only the values searched completely until then are cached.
+
+ @param start The value to search from.
+ @param cache The results of earlier searches, extended by this one.
+ @param meter The budget of the search.
+ @param log Receives the messages of the analysis.
+ @return The store, or a `nullptr` if no store of a constant is reachable or the budget ran out.
+ */
+StoreInst* getRelevantStoreFromValue(Value* start, StoreCache& cache, BudgetMeter& meter, raw_ostream& log) {
+    auto cached = cache.sent.find(start);
+    if (cached != cache.sent.end())
+        return cached->second;
+    if (cache.storeless.find(start) != cache.storeless.end())
+        return nullptr;
+
+    std::unordered_map<Value*, unsigned> index_of {};
+    std::unordered_set<Value*> on_stack {};
+    std::vector<Value*> cycle_stack {};
+    std::vector<SearchFrame> frames {};
+
+    auto enter = [&](Value* val) {
+        if (!meter.enter())
+            return false;
+
+        unsigned idx = static_cast<unsigned>(index_of.size());
+        index_of[val] = idx;
+        on_stack.insert(val);
+        cycle_stack.push_back(val);
+        frames.push_back(SearchFrame {val, {}, 0, idx, idx, true});
+        getSearchSteps(val, frames.back().steps);
+
+        // emit information about detected phi nodes for debugging purposes
+        if (PHINode* pn = dyn_cast<PHINode>(val))
+            // this is just a side note since PHI node encounters are really rare (only one in early tests)
+            log << "[DEBUG] Found a phi node!\n    " << pn->getModule()->getName() << "\n";
+        return true;
+    };
+
+    if (!enter(start))
+        return nullptr;
+    while (!frames.empty()) {
+        SearchFrame& frame = frames.back();
+
+        if (frame.next_step < frame.steps.size()) {
+            SearchStep step = frame.steps[frame.next_step++];
+            if (step.hit) {
+                // the first store found is the result of every value on the stack
+                for (std::size_t idx = 0; idx < frames.size(); ++idx)
+                    meter.leave();
+                cache.sent[start] = step.hit;
+                return step.hit;
+            }
+
+            if (cache.storeless.find(step.next) != cache.storeless.end())
+                continue;
+            else if (index_of.find(step.next) == index_of.end()) {
+                // `frame` is invalidated by entering the next value
+                if (!enter(step.next)) {
+                    log << "[WARN] The search for the sent value ran out of its budget.\n";
+                    return nullptr;
+                }
+            }
+            else if (on_stack.find(step.next) != on_stack.end())
+                frame.low = std::min(frame.low, index_of[step.next]);
             else
-                deep_store_inst = getRelevantStoreFromValue(mi->getRawDest(), val, been_there);
+                // searched already without reaching a store, but its cycle was not complete
+                frame.exact = false;
+            continue;
+        }
 
-            if (deep_store_inst != nullptr)
-                return deep_store_inst;
+        SearchFrame done = std::move(frame);
+        frames.pop_back();
+        meter.leave();
+
+        // the value completes a cycle (or is on none), no store is reachable from any of its values
+        if (done.low == done.index) {
+            Value* member;
+            do {
+                member = cycle_stack.back();
+                cycle_stack.pop_back();
+                on_stack.erase(member);
+                if (done.exact)
+                    cache.storeless.insert(member);
+            } while (member != done.val);
         }
-        if (GetElementPtrInst* gi = dyn_cast<GetElementPtrInst>(u)) {
-            StoreInst* deep_store_inst = getRelevantStoreFromValue(gi, val, been_there);
-            if (deep_store_inst != nullptr)
-                return deep_store_inst;
+
+        if (!frames.empty()) {
+            SearchFrame& parent = frames.back();
+            parent.low = std::min(parent.low, done.low);
+            parent.exact = parent.exact && done.exact;
         }
     }
-    //    outs() << "[WARN] Unhandled value type: " << *val << "\n";
 
+    cache.sent[start] = nullptr;
+    return nullptr;
+}
+
+
+// the message argument of a send, senders can either be call or invoke instructions
+static Value* getSentValue(Instruction* inst) {
+    if (InvokeInst* ii = dyn_cast<InvokeInst>(inst))
+        return ii->getArgOperand(ii->getNumArgOperands() - 1);
+    if (CallInst* ci = dyn_cast<CallInst>(inst))
+        return ci->getArgOperand(ci->getNumArgOperands() - 1);
     return nullptr;
 }
 
@@ -93,26 +199,21 @@ StoreInst* getRelevantStoreFromValue(Value* val, Value* prev, std::unordered_set
  This is the central entry point for all sender-analysis matters.
 
  @param inst The invocation of the `send` instruction.
+ @param cache The values searched by earlier calls, see `getRelevantStoreFromValue`.
+ @param meter The budget of the analysis, exhausted if the result is inconclusive.
+ @param log Receives the messages of the analysis.
  @return Returns the assigned constant.
  */
-long long analyzeSender(Instruction* inst) {
-    // senders can either be call of invoke instructions!
-
-    Value* a = nullptr;
+long long analyzeSender(Instruction* inst, StoreCache& cache, BudgetMeter& meter, raw_ostream& log) {
     // start analysis at the value provided as argument to send()
-    if (InvokeInst* ii = dyn_cast<InvokeInst>(inst))
-        a = ii->getArgOperand(ii->getNumArgOperands() - 1);
-    else if (CallInst* ci = dyn_cast<CallInst>(inst))
-        a = ci->getArgOperand(ci->getNumArgOperands() - 1);
-
+    Value* a = getSentValue(inst);
     if (!a)
         return -1;
 
     // outs() << "[DEBUG] Identified argument " << *a << "\n";
 
-    std::unordered_set<Value*> been_there {};
-    // start the recursive search for an assignment
-    StoreInst* si = getRelevantStoreFromValue(a, nullptr, &been_there);
+    // search for an assignment
+    StoreInst* si = getRelevantStoreFromValue(a, cache, meter, log);
 
     if (si == nullptr) {
         // outs() << "[NOTE] No store instruction found!\n"; // \
@@ -121,10 +222,10 @@ long long analyzeSender(Instruction* inst) {
         return -1;
     } else {
         if (ConstantInt* assigned_number = dyn_cast<ConstantInt>(si->getValueOperand())) {
-            outs() << "[SUCCESS] Found a viable assignment: " << assigned_number->getValue() << " is assigned.\n";
+            log << "[SUCCESS] Found a viable assignment: " << assigned_number->getValue() << " is assigned.\n";
             return assigned_number->getValue().getSExtValue();
         } else {
-            errs() << "[ERR] Could only find: " << *si << "\n";  // TODO: Can be removed since this is checked in the function now
+            log << "[ERR] Could only find: " << *si << "\n";  // TODO: Can be removed since this is checked in the function now
             return -1;
         }
     }
@@ -133,49 +234,60 @@ long long analyzeSender(Instruction* inst) {
 }
 
 
+/**
+ Look up the values a `send` instruction may transmit in the constant propagation of its function.
 
-/***************************************** Receiver Analysis *****************************************/
-
-bool isResultUnwrap(InvokeInst* ii) {
-    if (!ii->getCalledFunction() || !ii->getCalledFunction()->hasName())
-        return false;
+ @param inst The invocation of the `send` instruction.
+ @param flow The analysis of the function containing the send.
+ @param log Receives the messages of the analysis.
+ @return The possible values, sorted. Empty if they are unknown.
+ */
+std::vector<long long> analyzeSenderDataflow(Instruction* inst, const SentValueFlow& flow, raw_ostream& log) {
+    Value* a = getSentValue(inst);
+    if (!a)
+        return std::vector<long long>();
 
-    // first, demangle the function name
-    int s;
-    const char* demangled_name = itaniumDemangle(ii->getCalledFunction()->getName().str().c_str(), nullptr, nullptr, &s);
-    if (s != 0) {
-        return false;
+    ValueSet values = flow.valuesOf(a);
+    if (values.top) {
+        log << "[ERR] The message may hold any value.\n";
+        return std::vector<long long>();
     }
 
-    std::string demangled_invoke = demangled_name;
-    unsigned long position = demangled_invoke.find("$LT$core..result..Result$LT$T$C$$u20$E$GT$$GT$::unwrap::");
-    if (position != std::string::npos)
-        return true;
-    else
-        return false;
+    if (!values.values.empty())
+        log << "[SUCCESS] Found " << values.values.size() << " viable assignment(s).\n";
+    return values.values;
 }
 
 
-bool isResultUnwrap(CallInst* ci) {
-    if (!ci->getCalledFunction() || !ci->getCalledFunction()->hasName())
-        return false;
+/**
+ Find the values a `send` instruction may transmit from the stores that reach it, see `StoreResolver`.
 
-    // first, demangle the function name
-    int s;
-    const char* demangled_name = itaniumDemangle(ci->getCalledFunction()->getName().str().c_str(), nullptr, nullptr, &s);
-    if (s != 0) {
-        return false;
+ @param inst The invocation of the `send` instruction.
+ @param resolver The MemorySSA of the function containing the send.
+ @param meter The budget of the analysis, exhausted if the result is inconclusive.
+ @param log Receives the messages of the analysis.
+ @return The possible values, sorted. Empty if they are unknown.
+ */
+std::vector<long long> analyzeSenderMemorySSA(Instruction* inst, StoreResolver& resolver, BudgetMeter& meter, raw_ostream& log) {
+    Value* a = getSentValue(inst);
+    if (!a)
+        return std::vector<long long>();
+
+    ValueSet values = resolver.valuesOf(inst, a, meter);
+    if (values.top) {
+        log << "[ERR] A store of an unknown value reaches the send.\n";
+        return std::vector<long long>();
     }
 
-    std::string demangled_invoke = demangled_name;
-    unsigned long position = demangled_invoke.find("$LT$core..result..Result$LT$T$C$$u20$E$GT$$GT$::unwrap::");
-    if (position != std::string::npos)
-        return true;
-    else
-        return false;
+    if (!values.values.empty())
+        log << "[SUCCESS] Found " << values.values.size() << " viable assignment(s).\n";
+    return values.values;
 }
 
 
+
+/***************************************** Receiver Analysis *****************************************/
+
 /**
  Recursively iterates over the value produced by the receive instruction and the subsequent values
  produced by bitcasts, load and store instructions, etc.
@@ -187,67 +299,68 @@ bool isResultUnwrap(CallInst* ci) {
  @param val The value to inspect, initially an InvokeInst.
  @param been_there A set used to detect loops and avoid re-visiting nodes.
  @param possible_matches This map collects the possible matches we will inspect later on.
+ @param meter The budget of the search, every value is a step and every call a level.
  */
-void analyzeReceiveInst(Value* val, std::unordered_set<Value*>* been_there, std::unordered_map<BasicBlock*, Instruction*>* possible_matches) {
+void analyzeReceiveInst(Value* val, std::unordered_set<Value*>* been_there, std::unordered_map<BasicBlock*, Instruction*>* possible_matches, BudgetMeter& meter) {
     if (been_there->find(val) == been_there->end())
         been_there->insert(val);
     else
         return;
 
+    BudgetScope scope(meter);
+    if (!scope)
+        return;
+
     // follow the instruction types
     // identify and handle unwrap operations!
 
     // the current value is an invoke instruction (e.g. a `receive` call or an unwrap etc)
     if (InvokeInst* ii = dyn_cast<InvokeInst>(val)) {
         if (ii->getCalledFunction()) {
-            // first, demangle the function name to be able to check what function we are looking at
-            int s;
-            const char* demangled_name = itaniumDemangle(ii->getCalledFunction()->getName().str().c_str(), nullptr, nullptr, &s);
-            if (s == 0 && isRecv(demangled_name) && ii->hasStructRetAttr())
+            // check what function we are looking at
+            if (classifyCallee(ii->getCalledFunction()).kind == RecvCallee && ii->hasStructRetAttr())
                 // if the instruction is the receive (this is always true for the instruction we start with), follow the return
-                    analyzeReceiveInst(ii->getArgOperand(0), been_there, possible_matches);
+                    analyzeReceiveInst(ii->getArgOperand(0), been_there, possible_matches, meter);
         }
     }
     else if (CallInst* ci = dyn_cast<CallInst>(val)) {
         if (ci->getCalledFunction()) {
-            // first, demangle the function name to be able to check what function we are looking at
-            int s;
-            const char* demangled_name = itaniumDemangle(ci->getCalledFunction()->getName().str().c_str(), nullptr, nullptr, &s);
-            if (s == 0 && isRecv(demangled_name) && ci->hasStructRetAttr())
+            // check what function we are looking at
+            if (classifyCallee(ci->getCalledFunction()).kind == RecvCallee && ci->hasStructRetAttr())
                 // if the instruction is the receive (this is always true for the instruction we start with), follow the return
-                analyzeReceiveInst(ci->getArgOperand(0), been_there, possible_matches);
+                analyzeReceiveInst(ci->getArgOperand(0), been_there, possible_matches, meter);
         }
     }
     else if (BitCastInst* bi = dyn_cast<BitCastInst>(val))
-        analyzeReceiveInst(bi->getOperand(0), been_there, possible_matches);
+        analyzeReceiveInst(bi->getOperand(0), been_there, possible_matches, meter);
 
     for (User* u: val->users()) {
         if (StoreInst* si = dyn_cast<StoreInst>(u)) {
             if (si->getPointerOperand() != val) // TODO: this might be redundant?
-                analyzeReceiveInst(si->getPointerOperand(), been_there, possible_matches);
+                analyzeReceiveInst(si->getPointerOperand(), been_there, possible_matches, meter);
             else
-                analyzeReceiveInst(si->getValueOperand(), been_there, possible_matches);
+                analyzeReceiveInst(si->getValueOperand(), been_there, possible_matches, meter);
         }
         else if (LoadInst* li = dyn_cast<LoadInst>(u)) {
-            analyzeReceiveInst(li, been_there, possible_matches);
+            analyzeReceiveInst(li, been_there, possible_matches, meter);
             if (li->getPointerOperand() != val)
-                analyzeReceiveInst(li->getPointerOperand(), been_there, possible_matches);
+                analyzeReceiveInst(li->getPointerOperand(), been_there, possible_matches, meter);
         }
         else if (BitCastInst* bi = dyn_cast<BitCastInst>(u)) {
-            analyzeReceiveInst(bi, been_there, possible_matches);
+            analyzeReceiveInst(bi, been_there, possible_matches, meter);
             if (bi->getOperand(0) != val)
-                analyzeReceiveInst(bi->getOperand(0), been_there, possible_matches);
+                analyzeReceiveInst(bi->getOperand(0), been_there, possible_matches, meter);
         }
         else if (MemTransferInst* mi = dyn_cast<MemTransferInst>(u)) {
-            analyzeReceiveInst(mi->getRawDest(), been_there, possible_matches);
+            analyzeReceiveInst(mi->getRawDest(), been_there, possible_matches, meter);
             if (mi->getRawSource() != val)
-                analyzeReceiveInst(mi->getRawSource(), been_there, possible_matches);
+                analyzeReceiveInst(mi->getRawSource(), been_there, possible_matches, meter);
         }
         else if (GetElementPtrInst* gi = dyn_cast<GetElementPtrInst>(u)) {
-            analyzeReceiveInst(gi, been_there, possible_matches);
+            analyzeReceiveInst(gi, been_there, possible_matches, meter);
         }
         else if (ZExtInst* zi = dyn_cast<ZExtInst>(u)) {
-            analyzeReceiveInst(zi, been_there, possible_matches);
+            analyzeReceiveInst(zi, been_there, possible_matches, meter);
         }
         else if (SwitchInst* si = dyn_cast<SwitchInst>(u)) {
             possible_matches->insert({si->getParent(), si});
@@ -259,10 +372,10 @@ void analyzeReceiveInst(Value* val, std::unordered_set<Value*>* been_there, std:
                 possible_matches->insert({ii->getParent(), ii});
                 if (ii->hasStructRetAttr()) {
                     been_there->insert(ii);
-                    analyzeReceiveInst(ii->getArgOperand(0), been_there, possible_matches);
+                    analyzeReceiveInst(ii->getArgOperand(0), been_there, possible_matches, meter);
                 }
                 else
-                    analyzeReceiveInst(ii, been_there, possible_matches);
+                    analyzeReceiveInst(ii, been_there, possible_matches, meter);
             }
             else if (been_there->find(ii) == been_there->end()){
                 been_there->insert(ii);
@@ -277,10 +390,10 @@ void analyzeReceiveInst(Value* val, std::unordered_set<Value*>* been_there, std:
                 possible_matches->insert({ci->getParent(), ci});
                 if (ci->hasStructRetAttr()) {
                     been_there->insert(ci);
-                    analyzeReceiveInst(ci->getArgOperand(0), been_there, possible_matches);
+                    analyzeReceiveInst(ci->getArgOperand(0), been_there, possible_matches, meter);
                 }
                 else
-                    analyzeReceiveInst(ci, been_there, possible_matches);
+                    analyzeReceiveInst(ci, been_there, possible_matches, meter);
             }
             else if (been_there->find(ci) == been_there->end()){
                 been_there->insert(ci);
@@ -294,30 +407,89 @@ void analyzeReceiveInst(Value* val, std::unordered_set<Value*>* been_there, std:
 }
 
 
+/**
+ The state of the search for the usage of a received value in the control flow graph.
+ */
+struct UsageSearch {
+    std::unordered_map<BasicBlock*, Instruction*>* possible_matches;
+    unsigned long matches_version;          ///< Counts the matches dropped so far, the matches only shrink.
+    std::unordered_set<BasicBlock*> path;   ///< The blocks on the current path, to detect loops.
+    bool exact;                             ///< The current result ran into no loop, it is the same on every path.
+    std::map<std::tuple<BasicBlock*, Instruction*, unsigned long>, std::pair<UsageType, Instruction*>> results;  ///< The results by block, last hit and matches version.
+    BudgetMeter& meter;
+    raw_ostream& log;
+};
+
+
+static std::pair<UsageType, Instruction*> findUsageInBlock(BasicBlock* bb, UsageSearch& search, bool valueUnwrapped, Instruction* last_hit);
+
+
+// a checked match is not looked at again, the results found before apply to the old matches only
+static void dropMatch(UsageSearch& search, BasicBlock* bb) {
+    search.possible_matches->erase(bb);
+    ++search.matches_version;
+}
+
+
 /**
  This function takes the map of possible matches and the basic block after the recv() call and
  then traverses the control flow graph in order to match the instructions from the possible_matches
  set to the control flow graph and find the value unwraps and message usages.
 
+ Every block is searched only once per unwrap state (the last hit) and set of possible matches,
+ later visits reuse the result.
+ Without that, every path through a chain of branches (e.g. a `match` in an event loop) would be
+ walked separately. A result that ran into a loop depends on the path it was reached on (the loop
+ is cut at a different block), it is not reused.
+
  @param bb The initial basic block to begin the search from.
- @param possible_matches The map of possible matches generated from the `analyzeReceiveInst` function
+ @param search The possible matches generated from the `analyzeReceiveInst` function, the current path and the results so far.
  @param valueUnwrapped Tracks wether the received value has been unwrapped yet.
  @param last_hit Tracks the last matched value fro mthe possible matches.
  @return The usage type and the corresponding instruction.
  */
-std::pair<UsageType, Instruction*> findUsageInstruction(BasicBlock* bb, std::unordered_set<BasicBlock*> path_history, std::unordered_map<BasicBlock*, Instruction*>* possible_matches, bool valueUnwrapped, Instruction* last_hit) {
+std::pair<UsageType, Instruction*> findUsageInstruction(BasicBlock* bb, UsageSearch& search, bool valueUnwrapped, Instruction* last_hit) {
     // outs() << "  Now checking: " << bb->getName() << "\n";
     // stop when no instructions to check are left or we are in a loop
-    if (possible_matches->size() == 0 || path_history.find(bb) != path_history.end()) {
-        outs() << "[WARN] All matches have been checked or detected loop.\n";
+    bool in_loop = search.path.find(bb) != search.path.end();
+    if (in_loop)
+        search.exact = false;
+    if (search.possible_matches->size() == 0 || in_loop) {
+        search.log << "[WARN] All matches have been checked or detected loop.\n";
         if (valueUnwrapped)
             return std::make_pair(UnwrappedDirectUse, last_hit);
         else
             return std::make_pair(DirectUse, nullptr);
     }
 
+    // the last hit is only set once the value is unwrapped, together with the matches left it describes the whole state
+    std::tuple<BasicBlock*, Instruction*, unsigned long> state = std::make_tuple(bb, last_hit, search.matches_version);
+    auto known = search.results.find(state);
+    if (known != search.results.end())
+        return known->second;
+
+    // out of budget, the whole search is inconclusive
+    BudgetScope scope(search.meter);
+    if (!scope)
+        return std::make_pair(Unchecked, nullptr);
+
     // mark the node as "visited on the current path"
-    path_history.insert(bb);
+    bool outer_exact = search.exact;
+    search.path.insert(bb);
+    search.exact = true;
+    std::pair<UsageType, Instruction*> result = findUsageInBlock(bb, search, valueUnwrapped, last_hit);
+    search.path.erase(bb);
+
+    if (search.exact)
+        search.results[state] = result;
+    search.exact = outer_exact && search.exact;
+    return result;
+}
+
+
+// the actual search of `findUsageInstruction`, once the block is known to be new
+static std::pair<UsageType, Instruction*> findUsageInBlock(BasicBlock* bb, UsageSearch& search, bool valueUnwrapped, Instruction* last_hit) {
+    std::unordered_map<BasicBlock*, Instruction*>* possible_matches = search.possible_matches;
 
     // FIXME: CallInsts can be here as well!
     if (BasicBlock* next_bb = bb->getSingleSuccessor()) {
@@ -325,7 +497,7 @@ std::pair<UsageType, Instruction*> findUsageInstruction(BasicBlock* bb, std::uno
         // BBs have 2+ successors (due to the nature of switch/invoke instructions)
         // outs() << "    -> skipping to next BB\n";
         // outs() << "       (" << bb->getParent()->getName() << ")\n";
-        return findUsageInstruction(next_bb, path_history, possible_matches, valueUnwrapped, last_hit);
+        return findUsageInstruction(next_bb, search, valueUnwrapped, last_hit);
     }
     else {
         // we have to handle multiple successors
@@ -340,8 +512,8 @@ std::pair<UsageType, Instruction*> findUsageInstruction(BasicBlock* bb, std::uno
                 }
                 else {
                     //                    outs() << " Is value unwrap. \n" << *inst << "\n";
-                    possible_matches->erase(bb);
-                    return findUsageInstruction(si->getSuccessor(1), path_history, possible_matches, true, inst);
+                    dropMatch(search, bb);
+                    return findUsageInstruction(si->getSuccessor(1), search, true, inst);
                 }
             }
             else if (InvokeInst* ii = dyn_cast<InvokeInst>(inst)) {
@@ -353,12 +525,12 @@ std::pair<UsageType, Instruction*> findUsageInstruction(BasicBlock* bb, std::uno
                 else {
                     if (isResultUnwrap(ii)) {
                         //                        outs() << " Is value unwrap. \n" << *ii << "\n";
-                        possible_matches->erase(bb);
-                        return findUsageInstruction(ii->getSuccessor(0), path_history, possible_matches, true, inst);
+                        dropMatch(search, bb);
+                        return findUsageInstruction(ii->getSuccessor(0), search, true, inst);
                     }
                     else {
                         //                        outs() << " Is direct handler function call.\n" << *ii << "\n";
-                        possible_matches->erase(bb);
+                        dropMatch(search, bb);
                         return std::make_pair(DirectHandlerCall, inst);
                     }
 
@@ -369,7 +541,7 @@ std::pair<UsageType, Instruction*> findUsageInstruction(BasicBlock* bb, std::uno
             // check every successor of the current basic block as we do not know what causes the split here
             std::pair<UsageType, Instruction*> result = std::make_pair(DirectUse, nullptr);
             for (BasicBlock* next_bb: bb->getTerminator()->successors()) {
-                std::pair<UsageType, Instruction*> tmp_result = findUsageInstruction(next_bb, path_history, possible_matches, valueUnwrapped, last_hit);
+                std::pair<UsageType, Instruction*> tmp_result = findUsageInstruction(next_bb, search, valueUnwrapped, last_hit);
                 if (tmp_result.first >= result.first)
                     result = tmp_result;
             }
@@ -386,8 +558,10 @@ std::pair<UsageType, Instruction*> findUsageInstruction(BasicBlock* bb, std::uno
  the receive() call in question.
 
  @param inst The invocation of the recv() function.
+ @param meter The budget of the analysis, exhausted if the result is inconclusive.
+ @param log Receives the messages of the analysis.
  */
-std::pair<UsageType, Instruction*> analyzeReceiver(Instruction* inst) {
+std::pair<UsageType, Instruction*> analyzeReceiver(Instruction* inst, BudgetMeter& meter, raw_ostream& log) {
     if (!isa<CallInst>(inst) && !isa<InvokeInst>(inst))
         return std::pair<UsageType, Instruction*>();
 
@@ -399,18 +573,29 @@ std::pair<UsageType, Instruction*> analyzeReceiver(Instruction* inst) {
     // outs() << "[INFO] Analyzing receive Instruction...\n" \
     // << "       " << *inst << "\n";
 
-    analyzeReceiveInst(inst, &been_there, &possible_matches);
+    analyzeReceiveInst(inst, &been_there, &possible_matches, meter);
+    // an incomplete set of possible matches would point to the wrong usage
+    if (meter.exhausted()) {
+        log << "[WARN] The search for the received value ran out of its budget.\n";
+        return std::make_pair(Unchecked, (Instruction*) nullptr);
+    }
 
     // outs() << "[INFO] Finding the relevant usage...\n";
 
     // now sort out the previously filtered instructions by traversing the Control Flow Graph,
     // starting at the first Basic block after the `receive` function was called
 
+    UsageSearch search {&possible_matches, 0, {}, true, {}, meter, log};
     std::pair<UsageType, Instruction*> usage;
     if (InvokeInst* ii = dyn_cast<InvokeInst>(inst))
-        usage = findUsageInstruction(ii->getSuccessor(0), {}, &possible_matches, false, nullptr);
+        usage = findUsageInstruction(ii->getSuccessor(0), search, false, nullptr);
     else
-        usage = findUsageInstruction(inst->getParent(), {}, &possible_matches, false, nullptr);
+        usage = findUsageInstruction(inst->getParent(), search, false, nullptr);
+
+    if (meter.exhausted()) {
+        log << "[WARN] The search for the usage of the received value ran out of its budget.\n";
+        return std::make_pair(Unchecked, (Instruction*) nullptr);
+    }
 
     /*
     switch (usage.first) {
@@ -1,7 +1,13 @@
 #ifndef analysis_hpp
 #define analysis_hpp
 
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 // just for io stuff
 #include <iostream>
@@ -20,9 +26,33 @@
 
 #include "types.hpp"
 #include "properties.hpp"
-
-
-long long analyzeSender(llvm::Instruction* ii);
-std::pair<UsageType, llvm::Instruction*> analyzeReceiver(llvm::Instruction* ii);
+#include "budget.hpp"
+#include "dataflow.hpp"
+#include "storeresolver.hpp"
+
+
+enum SenderAnalysis {
+    WalkSenderAnalysis,         ///< Search the store of a constant from every send separately.
+    DataflowSenderAnalysis,     ///< Propagate the constants through each function once, see `SentValueFlow`.
+    MemorySSASenderAnalysis     ///< Find the stores reaching each send with MemorySSA, see `StoreResolver`.
+};
+
+/// The results of the sender analysis, see `getRelevantStoreFromValue`.
+struct StoreCache {
+    std::unordered_map<llvm::Value*, llvm::StoreInst*> sent;   ///< The store found for every value searched from (`nullptr` if there is none).
+    std::unordered_set<llvm::Value*> storeless;                ///< The values no store of a constant is reachable from.
+};
+
+/// The state the sender analyses share between the sends of a function, created on first use.
+struct SenderState {
+    StoreCache cache;
+    std::unique_ptr<SentValueFlow> flow;
+    std::unique_ptr<StoreResolver> resolver;
+};
+
+long long analyzeSender(llvm::Instruction* ii, StoreCache& cache, BudgetMeter& meter, llvm::raw_ostream& log);
+std::vector<long long> analyzeSenderDataflow(llvm::Instruction* ii, const SentValueFlow& flow, llvm::raw_ostream& log);
+std::vector<long long> analyzeSenderMemorySSA(llvm::Instruction* ii, StoreResolver& resolver, BudgetMeter& meter, llvm::raw_ostream& log);
+std::pair<UsageType, llvm::Instruction*> analyzeReceiver(llvm::Instruction* ii, BudgetMeter& meter, llvm::raw_ostream& log);
 
 #endif /* analysis_hpp */
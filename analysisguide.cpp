@@ -6,54 +6,74 @@ bool isIgnorable(Function* fn) {
     if (!fn->hasName())
     return false;
 
-    std::forward_list<std::string> ignorable {"core::", "_$LT$core..", "alloc::", "_$LT$alloc.."}; //, "std::", "_$LT$std.."};
+    // compare the first path segment of the symbol, e.g. `core::...` or `<core::... as ...>::...`
+    std::forward_list<StringRef> ignorable {"core", "alloc"}; //, "std"};
+    std::forward_list<StringRef> ignorable_impls {"_$LT$core..", "_$LT$alloc.."}; //, "_$LT$std.."};
 
-    // demangle the function name
-    int s;
-    const char* demangled = itaniumDemangle(fn->getName().str().c_str(), nullptr, nullptr, &s);
-    if (s != 0) {
+    RustSymbol symbol;
+    if (!RustSymbol::parse(fn->getName(), symbol) || symbol.size() < 2)
         return false;
-    }
-
-    // outs() << "(" << demangled << ")";
 
-    std::string fn_name = demangled;
-    for (std::string str: ignorable)
-        if (fn_name.substr(0, str.size()) == str)
+    for (StringRef str: ignorable)
+        if (symbol[0] == str)
+            return true;
+    for (StringRef str: ignorable_impls)
+        if (symbol[0].startswith(str))
             return true;
 
     return false;
 }
 
 
-void analyzeFunction(std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* nodelist, Function* fn, std::pair<MessagingNode*, MessagingNode*> entry_point, const MessageMap* mmap, std::unordered_set<Function*>* visited_fns) {
+/// A function and the pair the traversal through it started at (`NoNode`s for a traversal from a function).
+typedef std::pair<Function*, NodePair> GuidedStart;
+
+
+// the matched pairs of a send, in the order of the pair list
+static const std::vector<NodePair>& getSendPairs(const SendIndex* send_index, const Instruction* send) {
+    static const std::vector<NodePair> none {};
+    auto pairs = send_index->find(send);
+    return pairs == send_index->end() ? none : pairs->second;
+}
+
+
+void analyzeFunction(const NodeStore& store, std::vector<NodePair>* nodelist, Function* fn, NodePair entry_point, const SendIndex* send_index, const SendSummaries* summaries, std::set<GuidedStart>* visited, BudgetMeter& meter, raw_ostream& log) {
 //     don't check ignorable functions
 //    if (isIgnorable(fn))
 //        return;
 
     if (fn->getSubprogram())
-        outs() << "Now checking: " << fn->getSubprogram()->getName() << "\n";
+        log << "Now checking: " << fn->getSubprogram()->getName() << "\n";
     else
-        outs() << "Now checking: " << fn->getName() << "\n";
+        log << "Now checking: " << fn->getName() << "\n";
 
-    // avoid loops
-    if (visited_fns->find(fn) != visited_fns->end() && visited_fns->size() > 0)
+    // avoid loops, a function reached by another pair is traversed again as it may take other paths
+    if (!visited->insert(std::make_pair(fn, entry_point)).second)
+        return;
+
+    // every function is a level of the traversal, every block a step
+    BudgetScope scope(meter);
+    if (!scope)
+        return;
+
+    // bodies of lazily loaded functions are only read once the traversal reaches them,
+    // functions defined in other modules cannot be followed at all
+    if (!ensureMaterialized(fn) || fn->isDeclaration())
         return;
-    visited_fns->insert(fn);
 
     // DEBUG
-//    outs() << "[DEBUG] Checking " << fn->getName() << "\n";
+//    log << "[DEBUG] Checking " << fn->getName() << "\n";
 
     // initialize containers for BasicBlock check
     std::unordered_set<BasicBlock*> been_there {};
     std::queue<BasicBlock*> unvisited {};
 
-    // if we have no entry point, we receive a pair of nullptrs
+    // if we have no entry point, we receive a pair of `NoNode`s
 
-    if (entry_point.first != nullptr && fn == entry_point.second->instr->getFunction()) {
-        if (CallInst* ci = dyn_cast<CallInst>(entry_point.second->instr))
+    if (entry_point.first != NoNode && fn == store[entry_point.second].instr->getFunction()) {
+        if (CallInst* ci = dyn_cast<CallInst>(store[entry_point.second].instr))
             unvisited.push(ci->getParent());
-        else if (InvokeInst* ii = dyn_cast<InvokeInst>(entry_point.second->instr))
+        else if (InvokeInst* ii = dyn_cast<InvokeInst>(store[entry_point.second].instr))
             unvisited.push(ii->getSuccessor(0));
     }
     else
@@ -64,57 +84,61 @@ void analyzeFunction(std::forward_list<std::pair<MessagingNode*, MessagingNode*>
         BasicBlock* cur = unvisited.front();
         unvisited.pop();
         been_there.insert(cur);
+        if (!meter.step())
+            return;
 
         for (Instruction& inst: *cur) {
             if (TerminatorInst* ti = dyn_cast<TerminatorInst>(&inst)) {
                 if (InvokeInst* ii = dyn_cast<InvokeInst>(&inst)) {
                     if (isSend(ii)) {
                         if (ii->getCalledFunction()->getSubprogram())
-                            outs() << "send " << ii->getCalledFunction()->getSubprogram()->getName();
+                            log << "send " << ii->getCalledFunction()->getSubprogram()->getName();
                         else
-                            outs() << "send " << ii->getCalledFunction()->getName();
+                            log << "send " << ii->getCalledFunction()->getName();
 
-                        if (entry_point.first != nullptr) {
-                            for (std::pair<MessagingNode*, MessagingNode*> node_pair: mmap->at(entry_point.second->nspace))
-                                // find `send` in message map
-                                if (node_pair.first->instr == ii) {
-                                    outs() << " got hit!";
+                        if (entry_point.first != NoNode) {
+                            for (NodePair node_pair: getSendPairs(send_index, ii))
+                                // the pairs of the send in the namespace of the entry point
+                                if (store[node_pair.first].nspace == store[entry_point.second].nspace) {
+                                    log << " got hit!";
                                     // add edge - I don't break here to catch wrongly matched pairings as well.
-                                    nodelist->push_front(node_pair);
+                                    nodelist->push_back(node_pair);
                                     // analyze the recv
-                                    analyzeFunction(nodelist, node_pair.second->instr->getFunction(), node_pair, mmap, visited_fns);
+                                    analyzeFunction(store, nodelist, store[node_pair.second].instr->getFunction(), node_pair, send_index, summaries, visited, meter, log);
                                 }
                         }
                         else {
                             // we have no entry point -> generate it using the invoke instruction
-                            for (std::pair<MessagingNode*, MessagingNode*> node_pair: mmap->at(getNamespace(ii)))
-                                // find `send` in message map
-                                if (node_pair.first->instr == ii) {
-                                    outs() << " got hit!";
-                                    // add edge - I don't break here to catch wrongly matched pairings as well.
-                                    nodelist->push_front(node_pair);
-                                    // analyze the recv
-                                    analyzeFunction(nodelist, node_pair.second->instr->getFunction(), node_pair, mmap, visited_fns);
-                                }
+                            for (NodePair node_pair: getSendPairs(send_index, ii)) {
+                                log << " got hit!";
+                                // add edge - I don't break here to catch wrongly matched pairings as well.
+                                nodelist->push_back(node_pair);
+                                // analyze the recv
+                                analyzeFunction(store, nodelist, store[node_pair.second].instr->getFunction(), node_pair, send_index, summaries, visited, meter, log);
+                            }
                         }
-                        outs() << "\n";
+                        log << "\n";
                     }
-                    else if (ii->getCalledFunction()) { // && ii->getCalledFunction()->getLinkage() > 0) { // TODO: Not sure if this is ok!
+                    else if (ii->getCalledFunction() && summaries->reachesSend(ii->getCalledFunction())) { // && ii->getCalledFunction()->getLinkage() > 0) { // TODO: Not sure if this is ok!
                         if (ii->getCalledFunction()->getSubprogram())
-                            outs() << "Analyze " << ii->getCalledFunction()->getSubprogram()->getName() << "\n";
+                            log << "Analyze " << ii->getCalledFunction()->getSubprogram()->getName() << "\n";
                         else
-                            outs() << "Analyze " << ii->getCalledFunction()->getName() << "\n";
-                        analyzeFunction(nodelist, ii->getCalledFunction(), entry_point, mmap, visited_fns);
+                            log << "Analyze " << ii->getCalledFunction()->getName() << "\n";
+                        analyzeFunction(store, nodelist, ii->getCalledFunction(), entry_point, send_index, summaries, visited, meter, log);
                     }
                 }
                 else if (SwitchInst* si = dyn_cast<SwitchInst>(&inst)) {
                     // *if* we have an assignment and know what happens to our message, use that knowledge!
-                    if (entry_point.first !=nullptr && entry_point.first->assignment != -1 && entry_point.second->usage.first == UnwrappedToSwitch) {
-                        if (&inst == entry_point.second->usage.second) {
-                            // we then only care about the successor the program will take
-                            BasicBlock* next = si->getSuccessor(static_cast<unsigned>(entry_point.first->assignment));
-                            if (been_there.find(next) == been_there.end())
-                                unvisited.push(next);
+                    if (entry_point.first != NoNode && !store[entry_point.first].assignments.empty() && store[entry_point.second].usage.first == UnwrappedToSwitch) {
+                        if (&inst == store[entry_point.second].usage.second) {
+                            // we then only care about the successors the program may take
+                            for (long long value: store[entry_point.first].assignments) {
+                                if (value < 0 || value >= si->getNumSuccessors())
+                                    continue;
+                                BasicBlock* next = si->getSuccessor(static_cast<unsigned>(value));
+                                if (been_there.find(next) == been_there.end())
+                                    unvisited.push(next);
+                            }
                             continue;
                         }
                     }
@@ -129,39 +153,37 @@ void analyzeFunction(std::forward_list<std::pair<MessagingNode*, MessagingNode*>
             else if (CallInst* ci = dyn_cast<CallInst>(&inst)) {
                 if (isSend(ci)) {
                     if (ci->getCalledFunction()->getSubprogram())
-                        outs() << "send call " << ci->getCalledFunction()->getSubprogram()->getName();
+                        log << "send call " << ci->getCalledFunction()->getSubprogram()->getName();
                     else
-                        outs() << "send call " << ci->getCalledFunction()->getName();
-                    if (entry_point.first != nullptr) {
-                        for (std::pair<MessagingNode*, MessagingNode*> node_pair: mmap->at(entry_point.second->nspace))
-                            // find `send` in message map
-                            if (node_pair.first->instr == ci) {
+                        log << "send call " << ci->getCalledFunction()->getName();
+                    if (entry_point.first != NoNode) {
+                        for (NodePair node_pair: getSendPairs(send_index, ci))
+                            // the pairs of the send in the namespace of the entry point
+                            if (store[node_pair.first].nspace == store[entry_point.second].nspace) {
                                 // add edge - I don't break here to catch wrongly matched pairings as well.
-                                nodelist->push_front(node_pair);
+                                nodelist->push_back(node_pair);
                                 // analyze the recv
-                                outs() << "pair " << &node_pair << "\n";
-                                analyzeFunction(nodelist, node_pair.second->instr->getFunction(), node_pair, mmap, visited_fns);
+                                log << "pair " << &node_pair << "\n";
+                                analyzeFunction(store, nodelist, store[node_pair.second].instr->getFunction(), node_pair, send_index, summaries, visited, meter, log);
                             }
                     }
                     else {
-                        for (std::pair<MessagingNode*, MessagingNode*> node_pair: mmap->at(getNamespace(ci)))
-                            // find `send` in message map
-                            if (node_pair.first->instr == ci) {
-                                outs() << " got hit!";
-                                // add edge - I don't break here to catch wrongly matched pairings as well.
-                                nodelist->push_front(node_pair);
-                                // analyze the recv
-                                analyzeFunction(nodelist, node_pair.second->instr->getFunction(), node_pair, mmap, visited_fns);
-                            }
+                        for (NodePair node_pair: getSendPairs(send_index, ci)) {
+                            log << " got hit!";
+                            // add edge - I don't break here to catch wrongly matched pairings as well.
+                            nodelist->push_back(node_pair);
+                            // analyze the recv
+                            analyzeFunction(store, nodelist, store[node_pair.second].instr->getFunction(), node_pair, send_index, summaries, visited, meter, log);
+                        }
                     }
-                    outs() << "\n";
+                    log << "\n";
                 }
-                else if (ci->getCalledFunction()) { // && ci->getCalledFunction()->getLinkage() > 0) {
+                else if (ci->getCalledFunction() && summaries->reachesSend(ci->getCalledFunction())) { // && ci->getCalledFunction()->getLinkage() > 0) {
                     if (ci->getCalledFunction()->getSubprogram())
-                        outs() << "Analyze " << ci->getCalledFunction()->getSubprogram()->getName() << "\n";
+                        log << "Analyze " << ci->getCalledFunction()->getSubprogram()->getName() << "\n";
                     else
-                        outs() << "Analyze " << ci->getCalledFunction()->getName() << "\n";
-                    analyzeFunction(nodelist, ci->getCalledFunction(), entry_point, mmap, visited_fns);
+                        log << "Analyze " << ci->getCalledFunction()->getName() << "\n";
+                    analyzeFunction(store, nodelist, ci->getCalledFunction(), entry_point, send_index, summaries, visited, meter, log);
                 }
             }
         }
@@ -169,15 +191,30 @@ void analyzeFunction(std::forward_list<std::pair<MessagingNode*, MessagingNode*>
 }
 
 
-std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* analyzeGuidedFromFunction(MessageMap mmap, std::string module_name) {
+// the traversals start at the receiving functions of the pairs (and the chosen function), every function they enter is called from one of them
+static void summarizeReceivers(const NodeStore& store, const std::vector<NodePair>* node_pairs, SendSummaries& summaries) {
+    for (NodePair pair: *node_pairs)
+        summaries.summarize(store[pair.second].instr->getFunction());
+}
+
+
+// the traversal ends early once the budget runs out, the graph shows the part explored so far
+static void reportTraversal(BudgetRecord record, std::vector<BudgetRecord>& records) {
+    if (record.limit != NoLimit)
+        outs() << "[WARN] The " << record.subject << " ran out of its budget, the graph is incomplete.\n";
+    records.push_back(std::move(record));
+}
+
+
+std::vector<NodePair>* analyzeGuidedFromFunction(const NodeStore& store, MessageMap mmap, const SendIndex& send_index, SendSummaries& summaries, StringId module_name, const AnalysisBudget& budget, std::vector<BudgetRecord>& records) {
     outs() << "Please select a function to start (Only sending functions are shown).\n";
 
     // print function names available
     std::unordered_map<std::string, Function*> function_map {};
-    for (std::pair<MessagingNode*, MessagingNode*> node: mmap[module_name]) {
-        std::string func_name = node.first->instr->getFunction()->getSubprogram()->getName();
+    for (NodePair node: mmap[module_name]) {
+        std::string func_name = store[node.first].instr->getFunction()->getSubprogram()->getName();
 //        outs() << "  " << func_name << "\n";
-        function_map[func_name] = node.first->instr->getFunction();
+        function_map[func_name] = store[node.first].instr->getFunction();
     }
 
     for (std::pair<std::string, Function*> fn: function_map)
@@ -192,54 +229,62 @@ std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* analyzeGuidedFromF
             break;
     }
 
-    std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* nodelist = new std::forward_list<std::pair<MessagingNode*, MessagingNode*>>();
+    std::vector<NodePair>* nodelist = new std::vector<NodePair>();
+    summaries.summarize(function_map[chosen_func]);
 
-    analyzeFunction(nodelist, function_map[chosen_func], std::make_pair(nullptr, nullptr), &mmap, new std::unordered_set<Function*>());
+    BudgetMeter meter(budget);
+    std::set<GuidedStart> visited {};
+    analyzeFunction(store, nodelist, function_map[chosen_func], std::make_pair(NoNode, NoNode), &send_index, &summaries, &visited, meter, outs());
+    reportTraversal(makeBudgetRecord("guided traversal from " + chosen_func, meter), records);
 
     return nodelist;
 }
 
 
-std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* analyzeGuided(const std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* node_pairs, bool ignore_initial_val, bool choose_function) {
+std::vector<NodePair>* analyzeGuided(const NodeStore& store, const std::vector<NodePair>* node_pairs, bool ignore_initial_val, bool choose_function, const AnalysisBudget& budget, std::vector<BudgetRecord>& records) {
     outs() << "[INFO] Starting guided analysis...\n";
 
     // generate a message map to get a list of message pairs, sorted by the namespace they belong to.
-    MessageMap mmap = buildMessageMap(node_pairs);
+    SendIndex send_index {};
+    MessageMap mmap = buildMessageMap(store, node_pairs, &send_index);
+    SendSummaries summaries {};
+    summarizeReceivers(store, node_pairs, summaries);
 
     // find point to start the analysis
     std::string starting_point = "";
+    StringId starting_id;
     outs() << "Please specify a starting point for the analysis. You may press enter to display matching components.\n";
     while (true) {
         outs() << "  > ";
         std::getline(std::cin, starting_point);
 
-        if (mmap.find(starting_point) != mmap.end())
+        if (findInterned(starting_point, starting_id) && mmap.find(starting_id) != mmap.end())
             break;
         else {
             outs() << "\nNo exact matches found!\n";
-            for (std::pair<std::string, std::forward_list<std::pair<MessagingNode*, MessagingNode*>>> node : mmap)
-                if (node.first.find(starting_point) != std::string::npos)
-                    outs() << "  " << node.first << "\n";
+            for (const std::pair<const StringId, std::vector<NodePair>>& node : mmap)
+                if (internedString(node.first).find(starting_point) != StringRef::npos)
+                    outs() << "  " << internedString(node.first) << "\n";
         }
     }
 
     // switch to a different function for this analysis
     if (choose_function) {
-        return analyzeGuidedFromFunction(std::move(mmap), starting_point);
+        return analyzeGuidedFromFunction(store, std::move(mmap), send_index, summaries, starting_id, budget, records);
     }
 
     // choose a message (content) from the initial sender
     outs() << "Please choose a message dispatch (via line number) to begin.\n";
-    std::forward_list<std::pair<unsigned, std::pair<MessagingNode*, MessagingNode*>>> node_refs {};
-    for (std::pair<MessagingNode*, MessagingNode*> initial_node: mmap[starting_point]) {
-        unsigned line = initial_node.first->instr->getDebugLoc()->getLine();
+    std::forward_list<std::pair<unsigned, NodePair>> node_refs {};
+    for (NodePair initial_node: mmap[starting_id]) {
+        unsigned line = store[initial_node.first].line;
 
-        outs() << "  Line: " << line << " - " << initial_node.first->type << "\n";
+        outs() << "  Line: " << line << " - " << internedString(store[initial_node.first].type) << "\n";
 //        outs() << "        > " << &initial_node << "\n";
         node_refs.push_front(std::make_pair(line, initial_node));
     }
 
-    std::pair<MessagingNode*, MessagingNode*> chosen_send;
+    NodePair chosen_send;
     unsigned chosen_line = 0;
     bool done = false;
     while (!done) {
@@ -250,7 +295,7 @@ std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* analyzeGuided(cons
 
         outs() << "input: " << chosen_line << "\n";
 
-        for (std::pair<unsigned, std::pair<MessagingNode*, MessagingNode*>> ref: node_refs) {
+        for (std::pair<unsigned, NodePair> ref: node_refs) {
 //            outs() << "Checking line " << ref.first << "\n";
             if (ref.first == chosen_line) {
                 outs() << "HIT: " << chosen_line << "\n";
@@ -262,27 +307,225 @@ std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* analyzeGuided(cons
         }
     }
 
-    outs() << "Name: " << chosen_send.first->instr->getFunction()->getSubprogram()->getName() << "\n";
+    outs() << "Name: " << store[chosen_send.first].instr->getFunction()->getSubprogram()->getName() << "\n";
 
     outs() << "[DEBUG] Message Properties:\n" \
-           << "     > Type: " << chosen_send.first->type << "\n" \
+           << "     > Type: " << internedString(store[chosen_send.first].type) << "\n" \
 //           << "     > Pair: " << chosen_send << "\n"
-           << "     > Line: " << chosen_send.first->instr->getDebugLoc()->getLine() << "\n";
-    if (chosen_send.first->assignment == -1 || ignore_initial_val) {
+           << "     > Line: " << store[chosen_send.first].instr->getDebugLoc()->getLine() << "\n";
+    if (store[chosen_send.first].assignments.empty() || ignore_initial_val) {
         outs() << "     > Instance unknown.\n";
 
         // let the user chose an instance
         outs() << "Choose an message instance to proceed. ";
         // TODO
     }
-    else
-        outs() << "     > Instance: " << chosen_send.first->assignment << "\n";
+    else {
+        outs() << "     > Instance: " << store[chosen_send.first].assignments.front();
+        for (long long value: store[chosen_send.first].assignments.slice(1))
+            outs() << ", " << value;
+        outs() << "\n";
+    }
 
     // let's start!
-    std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* nodelist = new std::forward_list<std::pair<MessagingNode*, MessagingNode*>>();
-    nodelist->push_front(chosen_send);
+    std::vector<NodePair>* nodelist = new std::vector<NodePair>();
+    nodelist->push_back(chosen_send);
 
-    analyzeFunction(nodelist, chosen_send.second->instr->getFunction(), chosen_send, &mmap, new std::unordered_set<Function*>());
+    BudgetMeter meter(budget);
+    std::set<GuidedStart> visited {};
+    analyzeFunction(store, nodelist, store[chosen_send.second].instr->getFunction(), chosen_send, &send_index, &summaries, &visited, meter, outs());
+    reportTraversal(makeBudgetRecord("guided traversal from " + internedString(starting_id).str() + ":" + std::to_string(chosen_line), meter), records);
 
     return nodelist;
 }
+
+
+// the name of a function as offered by the guided analysis: the name in the debug information, if there is one
+static std::string getGuidedName(Function* fn) {
+    if (fn->getSubprogram())
+        return fn->getSubprogram()->getName().str();
+    return fn->getName().str();
+}
+
+
+// the sending functions of a namespace named `name`, by their name in the debug information or their linkage name
+static std::vector<Function*> findGuidedFunctions(const std::map<std::pair<StringId, std::string>, Function*>& functions, StringId nspace, const std::string& name) {
+    auto function = functions.find(std::make_pair(nspace, name));
+    if (function != functions.end())
+        return {function->second};
+
+    std::vector<Function*> found {};
+    for (function = functions.lower_bound(std::make_pair(nspace, std::string())); function != functions.end() && function->first.first == nspace; ++function)
+        if (getGuidedName(function->second) == name)
+            found.push_back(function->second);
+    return found;
+}
+
+
+/**
+ Find where the traversals of an entry point begin. A function name shared by several sending
+ functions of the namespace (e.g. `{{closure}}` or `new`) is ambiguous, these functions have to be
+ named by their linkage name instead.
+
+ @param entry A send, `namespace:line`, or a sending function, `namespace:function`.
+ @param store The nodes.
+ @param mmap The matched pairs by the namespace of their send.
+ @param functions The sending functions by namespace and linkage name.
+ @param starts Receives the starts, one per matched pair of the sends at the line.
+ @return `false` (and a warning), if the entry point does not name a send or exactly one sending function.
+ */
+static bool resolveEntry(const std::string& entry, const NodeStore& store, const MessageMap& mmap, const std::map<std::pair<StringId, std::string>, Function*>& functions, std::vector<GuidedStart>& starts) {
+    std::size_t split = entry.rfind(':');
+    StringId nspace;
+    if (split == std::string::npos || !findInterned(entry.substr(0, split), nspace) || mmap.find(nspace) == mmap.end()) {
+        outs() << "[WARN] No send or sending function matches the entry point `" << entry << "`.\n";
+        return false;
+    }
+
+    std::string target = entry.substr(split + 1);
+    if (!target.empty() && std::all_of(target.begin(), target.end(), ::isdigit)) {
+        unsigned line;
+        if (StringRef(target).getAsInteger(10, line)) {
+            outs() << "[WARN] The line of the entry point `" << entry << "` is out of range.\n";
+            return false;
+        }
+        for (NodePair pair: mmap.at(nspace))
+            if (store[pair.first].line == line)
+                starts.push_back(std::make_pair(store[pair.second].instr->getFunction(), pair));
+    }
+    else {
+        std::vector<Function*> found = findGuidedFunctions(functions, nspace, target);
+        if (found.size() > 1) {
+            outs() << "[WARN] The entry point `" << entry << "` names " << found.size() << " sending functions, use one of their linkage names:\n";
+            for (Function* fn: found)
+                outs() << "    " << internedString(nspace) << ":" << fn->getName() << "\n";
+            return false;
+        }
+        if (found.size() == 1)
+            starts.push_back(std::make_pair(found.front(), std::make_pair(NoNode, NoNode)));
+    }
+
+    if (starts.empty())
+        outs() << "[WARN] No send or sending function matches the entry point `" << entry << "`.\n";
+    return !starts.empty();
+}
+
+
+/**
+ Run the guided analysis without interaction from a list of entry points (see `resolveEntry`), or
+ from every sending function. The traversals are independent of each other and run on up to
+ `thread_no` threads; entry points starting at the same function with the same pair share their
+ traversal. The messages of the traversals are printed in the order of the entry points.
+
+ The bodies of all functions of lazily loaded modules are read first, as the traversals cannot
+ materialize them concurrently.
+
+ @param store The nodes.
+ @param node_pairs The matched pairs.
+ @param entries The entry points, extended by every sending function if `all_functions` is set.
+ @param all_functions Start from every sending function.
+ @param thread_no The number of threads to use.
+ @param budget The budget of every traversal.
+ @param records Receives the work spent on every traversal.
+ @return The pairs explored from each entry point, in the order of the entry points.
+ */
+std::vector<GuidedResult> analyzeGuidedBatch(const NodeStore& store, const std::vector<NodePair>* node_pairs, std::vector<std::string> entries, bool all_functions, int thread_no, const AnalysisBudget& budget, std::vector<BudgetRecord>& records) {
+    outs() << "[INFO] Starting non-interactive guided analysis...\n";
+
+    SendIndex send_index {};
+    MessageMap mmap = buildMessageMap(store, node_pairs, &send_index);
+
+    std::map<std::pair<StringId, std::string>, Function*> functions {};
+    std::unordered_set<Module*> modules {};
+    for (const std::pair<const StringId, std::vector<NodePair>>& item: mmap)
+        for (NodePair pair: item.second) {
+            Function* fn = store[pair.first].instr->getFunction();
+            functions[std::make_pair(item.first, fn->getName().str())] = fn;
+            modules.insert(fn->getParent());
+            modules.insert(store[pair.second].instr->getModule());
+        }
+
+    for (Module* module: modules) {
+        if (Error e = module->materializeAll())
+            logAllUnhandledErrors(std::move(e), errs(), "[ERROR] Couldn't materialize `" + module->getModuleIdentifier() + "`: ");
+    }
+
+    // every function by its name in the debug information, or its linkage name if that is ambiguous
+    if (all_functions) {
+        std::map<std::pair<StringId, std::string>, unsigned> name_counts {};
+        for (const std::pair<const std::pair<StringId, std::string>, Function*>& function: functions)
+            ++name_counts[std::make_pair(function.first.first, getGuidedName(function.second))];
+
+        for (const std::pair<const std::pair<StringId, std::string>, Function*>& function: functions) {
+            std::string name = getGuidedName(function.second);
+            if (name_counts.at(std::make_pair(function.first.first, name)) > 1)
+                name = function.first.second;
+            entries.push_back(internedString(function.first.first).str() + ":" + name);
+        }
+    }
+
+    // every distinct start is traversed once
+    std::vector<GuidedStart> starts {};
+    std::map<GuidedStart, std::size_t> start_index {};
+    std::vector<std::vector<std::size_t>> entry_starts(entries.size());
+    for (std::size_t idx = 0; idx < entries.size(); ++idx) {
+        std::vector<GuidedStart> resolved {};
+        if (!resolveEntry(entries[idx], store, mmap, functions, resolved))
+            continue;
+
+        for (const GuidedStart& start: resolved) {
+            auto known = start_index.insert(std::make_pair(start, starts.size()));
+            if (known.second)
+                starts.push_back(start);
+            entry_starts[idx].push_back(known.first->second);
+        }
+    }
+
+    // the summaries are complete before the traversals share them
+    SendSummaries summaries {};
+    summarizeReceivers(store, node_pairs, summaries);
+    for (const GuidedStart& start: starts)
+        summaries.summarize(start.first);
+
+    outs() << "[INFO] Summarized " << summaries.size() << " functions, exploring " << entries.size() << " entry points in " << starts.size() << " traversals...\n";
+
+    std::vector<std::vector<NodePair>> explored(starts.size());
+    std::vector<std::string> messages(starts.size());
+    std::vector<BudgetRecord> start_records(starts.size());
+    parallelFor(thread_no, starts.size(), [&](unsigned, std::size_t idx) {
+        Function* fn = starts[idx].first;
+        NodePair entry_point = starts[idx].second;
+        raw_string_ostream log(messages[idx]);
+        std::set<GuidedStart> visited {};
+        BudgetMeter meter(budget);
+
+        // a traversal from a send includes the send's pair
+        if (entry_point.first != NoNode)
+            explored[idx].push_back(entry_point);
+        analyzeFunction(store, &explored[idx], fn, entry_point, &send_index, &summaries, &visited, meter, log);
+
+        std::string subject = "guided traversal from " + getGuidedName(fn);
+        if (entry_point.first != NoNode)
+            subject = "guided traversal from " + internedString(store[entry_point.first].nspace).str() + ":" + std::to_string(store[entry_point.first].line);
+        start_records[idx] = makeBudgetRecord(std::move(subject), meter);
+    });
+
+    for (std::size_t idx = 0; idx < starts.size(); ++idx) {
+        outs() << messages[idx];
+        reportTraversal(std::move(start_records[idx]), records);
+    }
+
+    // the pairs of an entry point, without duplicates
+    std::vector<GuidedResult> results {};
+    for (std::size_t idx = 0; idx < entries.size(); ++idx) {
+        GuidedResult result {entries[idx], {}};
+        std::set<NodePair> seen {};
+        for (std::size_t start: entry_starts[idx])
+            for (NodePair pair: explored[start])
+                if (seen.insert(pair).second)
+                    result.pairs.push_back(pair);
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
@@ -1,7 +1,12 @@
 #ifndef analysisguide_hpp
 #define analysisguide_hpp
 
+#include <algorithm>
+#include <cctype>
 #include <forward_list>
+#include <map>
+#include <set>
+#include <vector>
 #include <string>
 #include <list>
 #include <queue>
@@ -18,9 +23,21 @@
 #include "llvm/Demangle/Demangle.h"
 
 #include "types.hpp"
+#include "nodestore.hpp"
 #include "visualizer.hpp"
 #include "properties.hpp"
+#include "loader.hpp"
+#include "budget.hpp"
+#include "parallel.hpp"
+#include "summary.hpp"
 
-std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* analyzeGuided(const std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* node_pairs, bool ignore_initial_value, bool choose_function);
+/// An entry point of a non-interactive guided analysis and the pairs explored from it.
+struct GuidedResult {
+    std::string entry;              ///< The entry point as given, e.g. `src/main.rs:12`.
+    std::vector<NodePair> pairs;    ///< Empty if the entry point is unknown.
+};
+
+std::vector<NodePair>* analyzeGuided(const NodeStore& store, const std::vector<NodePair>* node_pairs, bool ignore_initial_value, bool choose_function, const AnalysisBudget& budget, std::vector<BudgetRecord>& records);
+std::vector<GuidedResult> analyzeGuidedBatch(const NodeStore& store, const std::vector<NodePair>* node_pairs, std::vector<std::string> entries, bool all_functions, int thread_no, const AnalysisBudget& budget, std::vector<BudgetRecord>& records);
 
 #endif /* analysisguide_hpp */
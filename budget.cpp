@@ -0,0 +1,120 @@
+#include "budget.hpp"
+
+using namespace llvm;
+
+
+BudgetMeter::BudgetMeter(const AnalysisBudget& budget) : budget(budget), start(std::chrono::steady_clock::now()), step_count(0), depth(0), max_depth(0), hit(NoLimit) {}
+
+
+unsigned long BudgetMeter::millis() const {
+    return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+
+/**
+ Count a step of the analysis.
+
+ @return `false`, if the budget has run out.
+ */
+bool BudgetMeter::step() {
+    if (hit != NoLimit)
+        return false;
+
+    ++step_count;
+    if (budget.max_steps && step_count > budget.max_steps)
+        hit = StepLimit;
+    // reading the clock is not free, every 64th step is precise enough
+    else if (budget.max_millis && step_count % 64 == 0 && millis() >= budget.max_millis)
+        hit = TimeLimit;
+
+    return hit == NoLimit;
+}
+
+
+/**
+ Count a step that goes one level deeper, `leave` has to be called for it if it is granted.
+
+ @return `false`, if the budget has run out.
+ */
+bool BudgetMeter::enter() {
+    if (!step())
+        return false;
+
+    if (budget.max_depth && depth >= budget.max_depth) {
+        hit = DepthLimit;
+        return false;
+    }
+
+    ++depth;
+    if (depth > max_depth)
+        max_depth = depth;
+    return true;
+}
+
+
+void BudgetMeter::leave() {
+    --depth;
+}
+
+
+BudgetRecord makeBudgetRecord(std::string subject, const BudgetMeter& meter) {
+    return BudgetRecord {std::move(subject), meter.limit(), meter.steps(), meter.maxDepth(), meter.millis()};
+}
+
+
+static const char* getLimitName(BudgetLimit limit) {
+    switch (limit) {
+        case StepLimit:
+            return "step limit";
+        case DepthLimit:
+            return "depth limit";
+        case TimeLimit:
+            return "time limit";
+        default:
+            return "no limit";
+    }
+}
+
+
+static void printRecord(const BudgetRecord& record, raw_ostream& out) {
+    out << record.steps << " steps, depth " << record.max_depth << ", " << record.millis << " ms";
+}
+
+
+/**
+ Print the nodes (and guided traversals) that ran out of their budget and the work each of them
+ used, followed by the most expensive analysis that completed, as a hint for tuning the budget.
+
+ @param records The work of every analyzed node and traversal.
+ @param budget The budget they were analyzed with.
+ @param out The stream to print to.
+ */
+void printBudgetSummary(const std::vector<BudgetRecord>& records, const AnalysisBudget& budget, raw_ostream& out) {
+    std::vector<const BudgetRecord*> exhausted {};
+    const BudgetRecord* peak = nullptr;
+    for (const BudgetRecord& record: records) {
+        if (record.limit != NoLimit)
+            exhausted.push_back(&record);
+        else if (!peak || record.steps > peak->steps)
+            peak = &record;
+    }
+
+    if (exhausted.empty()) {
+        out << "[INFO] Analysis budget: all " << records.size() << " analyses completed.\n";
+    }
+    else {
+        out << "[WARN] Analysis budget: " << exhausted.size() << " of " << records.size() << " analyses ran out of their budget (" \
+            << budget.max_steps << " steps, depth " << budget.max_depth << ", " << budget.max_millis << " ms; 0 is unlimited), their results are inconclusive:\n";
+        for (const BudgetRecord* record: exhausted) {
+            out << "  " << record->subject << ": " << getLimitName(record->limit) << " after ";
+            printRecord(*record, out);
+            out << "\n";
+        }
+    }
+
+    if (peak) {
+        out << "[INFO] Most expensive complete analysis: " << peak->subject << " with ";
+        printRecord(*peak, out);
+        out << "\n";
+    }
+}
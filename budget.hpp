@@ -0,0 +1,89 @@
+#ifndef budget_hpp
+#define budget_hpp
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// just for io stuff
+#include <iostream>
+#include "llvm/Support/raw_ostream.h"
+
+
+/// The limits of an analysis of a single node (or a single guided traversal). 0 means unlimited.
+struct AnalysisBudget {
+    unsigned long max_steps;    ///< The number of values/blocks/functions the analysis may visit.
+    unsigned max_depth;         ///< The depth of the search (recursion or search stack).
+    unsigned max_millis;        ///< The wall time in milliseconds.
+};
+
+enum BudgetLimit {
+    NoLimit,        ///< The budget has not run out.
+    StepLimit,      ///< The analysis visited `max_steps` values.
+    DepthLimit,     ///< The search went `max_depth` levels deep.
+    TimeLimit       ///< The analysis ran for `max_millis` milliseconds.
+};
+
+
+/**
+ Measures the work of an analysis against its budget. Once a limit is hit, the meter stays
+ exhausted and every further step is refused, the analysis is expected to unwind and report
+ its (incomplete) result as inconclusive.
+ */
+class BudgetMeter {
+public:
+    explicit BudgetMeter(const AnalysisBudget& budget);
+
+    bool step();
+    bool enter();
+    void leave();
+
+    bool exhausted() const { return hit != NoLimit; }
+    BudgetLimit limit() const { return hit; }
+    unsigned long steps() const { return step_count; }
+    unsigned maxDepth() const { return max_depth; }
+    unsigned long millis() const;
+
+private:
+    AnalysisBudget budget;
+    std::chrono::steady_clock::time_point start;
+    unsigned long step_count;
+    unsigned depth;
+    unsigned max_depth;
+    BudgetLimit hit;
+};
+
+
+/**
+ Enters a level of a recursive search for the lifetime of the scope. Converts to `false` if the
+ budget refused the step, the search has to return then.
+ */
+class BudgetScope {
+public:
+    explicit BudgetScope(BudgetMeter& meter) : meter(meter), entered(meter.enter()) {}
+    ~BudgetScope() { if (entered) meter.leave(); }
+
+    BudgetScope(const BudgetScope&) = delete;
+    BudgetScope& operator=(const BudgetScope&) = delete;
+
+    explicit operator bool() const { return entered; }
+
+private:
+    BudgetMeter& meter;
+    bool entered;
+};
+
+
+/// The work spent on a node or guided traversal, for the summary at the end of the run.
+struct BudgetRecord {
+    std::string subject;        ///< What has been analyzed, e.g. `send Msg at src/main.rs:12 (main)`.
+    BudgetLimit limit;
+    unsigned long steps;
+    unsigned max_depth;
+    unsigned long millis;
+};
+
+BudgetRecord makeBudgetRecord(std::string subject, const BudgetMeter& meter);
+void printBudgetSummary(const std::vector<BudgetRecord>& records, const AnalysisBudget& budget, llvm::raw_ostream& out);
+
+#endif /* budget_hpp */
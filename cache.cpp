@@ -0,0 +1,291 @@
+#include "cache.hpp"
+
+using namespace llvm;
+namespace fs = ::boost::filesystem;
+
+// bump this whenever the stored results change in meaning, old entries are ignored then
+static const char* cache_version = "rmpa-cache 3";
+
+
+/**
+ Compute the content hash of an IR file, which is used as key into the cache.
+
+ @param path The path of the file.
+ @param config_tag The registered channel APIs, results depend on them as well.
+ @return The hex encoded hash, or an empty string if the file could not be read.
+ */
+static std::string hashFile(const std::string& path, StringRef config_tag) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> buffer = MemoryBuffer::getFile(path);
+    if (!buffer)
+        return "";
+
+    MD5 hash;
+    hash.update(StringRef(cache_version));
+    hash.update(config_tag);
+    hash.update((*buffer)->getBuffer());
+
+    MD5::MD5Result result;
+    hash.final(result);
+    SmallString<32> hex;
+    MD5::stringifyResult(result, hex);
+
+    return hex.str().str();
+}
+
+
+static fs::path entryPath(const std::string& cache_dir, const std::string& key) {
+    return fs::path(cache_dir) / (key + ".rmpa");
+}
+
+
+// the fields of an entry are tab-separated, so tabs, newlines and backslashes are escaped
+static std::string escapeField(StringRef field) {
+    std::string escaped;
+    for (char c: field) {
+        if (c == '\\')
+            escaped.append("\\\\");
+        else if (c == '\t')
+            escaped.append("\\t");
+        else if (c == '\n')
+            escaped.append("\\n");
+        else
+            escaped.push_back(c);
+    }
+    return escaped;
+}
+
+
+static std::string unescapeField(const std::string& field) {
+    std::string unescaped;
+    for (std::size_t i = 0; i < field.size(); ++i) {
+        if (field[i] == '\\' && i + 1 < field.size()) {
+            ++i;
+            unescaped.push_back(field[i] == 't' ? '\t' : (field[i] == 'n' ? '\n' : field[i]));
+        }
+        else
+            unescaped.push_back(field[i]);
+    }
+    return unescaped;
+}
+
+
+// a node as read from a cache entry, before it is added to the node store
+struct CachedNode {
+    bool is_send;
+    unsigned line;
+    long long result;
+    std::vector<long long> values;
+    std::string type;
+    std::string nspace;
+    std::string function;
+    std::string channel;
+};
+
+
+/**
+ Read a cache entry. Every line holds one node:
+ `send|recv <TAB> line <TAB> assignments|usage <TAB> type <TAB> namespace <TAB> function <TAB> channel`
+ The assignments of a send are separated by commas, -1 if there are none.
+
+ @param path The path of the entry.
+ @param nodes Receives the restored nodes in the order they were written in.
+ @return `true`, if the entry exists and could be read completely.
+ */
+static bool readEntry(const fs::path& path, std::vector<CachedNode>& nodes) {
+    std::ifstream entry(path.string());
+    if (!entry.good())
+        return false;
+
+    std::string line;
+    if (!std::getline(entry, line) || line != cache_version)
+        return false;
+
+    std::vector<CachedNode> read_nodes {};
+    while (std::getline(entry, line)) {
+        std::vector<std::string> fields {};
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t'))
+            fields.push_back(unescapeField(field));
+        // the function name and the channel may legitimately be empty
+        if (fields.size() < 5 || fields.size() > 7)
+            return false;
+        fields.resize(7);
+
+        if (fields[0] != "send" && fields[0] != "recv")
+            return false;
+
+        // a truncated or corrupt entry is a miss
+        CachedNode node {fields[0] == "send", 0, -1, {}, fields[3], fields[4], fields[5], fields[6]};
+        if (StringRef(fields[1]).getAsInteger(10, node.line))
+            return false;
+        if (node.is_send) {
+            std::stringstream values(fields[2]);
+            std::string value;
+            while (std::getline(values, value, ',')) {
+                long long parsed;
+                if (StringRef(value).getAsInteger(10, parsed))
+                    return false;
+                if (parsed != -1)
+                    node.values.push_back(parsed);
+            }
+        }
+        else if (StringRef(fields[2]).getAsInteger(10, node.result))
+            return false;
+        read_nodes.push_back(std::move(node));
+    }
+
+    nodes = std::move(read_nodes);
+    return true;
+}
+
+
+static std::string escapeChannel(StringId channel) {
+    return channel == NoChannel ? "" : escapeField(internedString(channel));
+}
+
+
+static std::string joinAssignments(ArrayRef<long long> values) {
+    if (values.empty())
+        return "-1";
+
+    std::string joined = std::to_string(values.front());
+    for (long long value: values.slice(1))
+        joined += "," + std::to_string(value);
+    return joined;
+}
+
+
+static void writeEntry(const fs::path& path, const NodeStore& store, const std::vector<NodeId>& sends, const std::vector<NodeId>& recvs) {
+    // write to a temporary file first, so concurrent runs never see partial entries
+    fs::path tmp_path = path.parent_path() / fs::unique_path("%%%%-%%%%-%%%%.tmp");
+    std::ofstream entry(tmp_path.string());
+    if (!entry.good()) {
+        std::cerr << "[WARN] Could not write cache entry " << path.string() << std::endl;
+        return;
+    }
+
+    entry << cache_version << "\n";
+    for (NodeId id: sends) {
+        const MessagingNode& send = store[id];
+        entry << "send\t" << send.line << "\t" << joinAssignments(send.assignments) << "\t" << escapeField(internedString(send.type)) \
+              << "\t" << escapeField(internedString(send.nspace)) << "\t" << escapeField(send.function) << "\t" << escapeChannel(send.channel) << "\n";
+    }
+    for (NodeId id: recvs) {
+        const MessagingNode& recv = store[id];
+        entry << "recv\t" << recv.line << "\t" << static_cast<int>(recv.usage.first) << "\t" << escapeField(internedString(recv.type)) \
+              << "\t" << escapeField(internedString(recv.nspace)) << "\t" << escapeField(recv.function) << "\t" << escapeChannel(recv.channel) << "\n";
+    }
+    entry.close();
+
+    boost::system::error_code ec;
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        std::cerr << "[WARN] Could not write cache entry " << path.string() << std::endl;
+        fs::remove(tmp_path, ec);
+    }
+}
+
+
+/**
+ Look up the results of all input files in the analysis cache. The nodes of files with an
+ up-to-date entry are restored (without an instruction attached), all other files are returned
+ for parsing. The cache keys of these files are handed back through `keys` for `store_cache`.
+
+ @param cache_dir The cache directory.
+ @param files The candidate files.
+ @param thread_no The number of threads used for hashing.
+ @param options The analysis options changing the results, entries written with other options do not apply.
+ @param keys Receives the cache keys of the files that have to be parsed.
+ @param store Receives the restored nodes.
+ @return The files that have to be parsed and analyzed.
+ */
+std::forward_list<std::string> lookup_cache(const std::string& cache_dir, const std::forward_list<std::string>& files, int thread_no, const std::string& options, std::unordered_map<std::string, std::string>& keys, NodeStore& store) {
+    std::vector<std::string> paths(files.begin(), files.end());
+    std::vector<std::string> hashes(paths.size());
+    std::vector<char> hit(paths.size(), 0);
+    std::string config_tag = channelConfigTag() + options;
+    std::vector<std::vector<CachedNode>> hit_nodes(paths.size());
+
+    parallelFor(thread_no, paths.size(), [&](unsigned, std::size_t idx) {
+        hashes[idx] = hashFile(paths[idx], config_tag);
+        if (!hashes[idx].empty())
+            hit[idx] = readEntry(entryPath(cache_dir, hashes[idx]), hit_nodes[idx]);
+    });
+
+    // the nodes are added in file order, independent of the thread that read them
+    unsigned cached = 0;
+    for (std::size_t idx = 0; idx < paths.size(); ++idx) {
+        if (!hit[idx])
+            continue;
+
+        ++cached;
+        for (const CachedNode& node: hit_nodes[idx]) {
+            NodeId id;
+            if (node.is_send) {
+                id = store.addSend(nullptr, intern(node.type), intern(node.nspace), node.line, node.function, -1);
+                store.setAssignments(id, node.values);
+            }
+            else
+                id = store.addRecv(nullptr, intern(node.type), intern(node.nspace), node.line, node.function, static_cast<UsageType>(node.result));
+            if (!node.channel.empty())
+                store[id].channel = intern(node.channel);
+        }
+    }
+
+    std::forward_list<std::string> remaining {};
+    for (std::size_t idx = paths.size(); idx-- > 0;) {
+        if (!hit[idx]) {
+            remaining.push_front(paths[idx]);
+            if (!hashes[idx].empty())
+                keys[paths[idx]] = hashes[idx];
+        }
+    }
+
+    std::cout << "[INFO] Analysis cache: " << cached << " of " << paths.size() << " files are up to date." << std::endl;
+
+    return remaining;
+}
+
+
+/**
+ Write the analysis results of all freshly parsed modules into the cache. Must be called after the
+ sender and receiver analyses have been run, as their results are stored as well. Modules with
+ nodes whose analysis ran out of its budget are not stored, they are analyzed again next time.
+
+ @param cache_dir The cache directory.
+ @param modules The modules that have been parsed in this run.
+ @param keys The cache keys produced by `lookup_cache`.
+ @param store All nodes. Nodes that are not attached to an instruction are ignored.
+ */
+void store_cache(const std::string& cache_dir, const std::forward_list<std::unique_ptr<Module>>& modules, const std::unordered_map<std::string, std::string>& keys, const NodeStore& store) {
+    boost::system::error_code ec;
+    fs::create_directories(cache_dir, ec);
+    if (ec) {
+        std::cerr << "[WARN] Could not create the cache directory " << cache_dir << std::endl;
+        return;
+    }
+
+    // group the nodes by the module (and thus the file) they originate from
+    std::unordered_map<std::string, std::pair<std::vector<NodeId>, std::vector<NodeId>>> module_nodes {};
+    std::unordered_set<std::string> inconclusive {};
+    for (NodeId id: store.sends())
+        if (store[id].instr)
+            module_nodes[store[id].instr->getModule()->getModuleIdentifier()].first.push_back(id);
+    for (NodeId id: store.recvs())
+        if (store[id].instr)
+            module_nodes[store[id].instr->getModule()->getModuleIdentifier()].second.push_back(id);
+    for (NodeId id = 0; id < store.size(); ++id)
+        if (store[id].instr && store[id].inconclusive)
+            inconclusive.insert(store[id].instr->getModule()->getModuleIdentifier());
+
+    // modules without any nodes get an (empty) entry as well
+    for (const std::unique_ptr<Module>& mod: modules) {
+        auto key = keys.find(mod->getModuleIdentifier());
+        if (key == keys.end() || inconclusive.count(mod->getModuleIdentifier()))
+            continue;
+
+        auto& nodes = module_nodes[mod->getModuleIdentifier()];
+        writeEntry(entryPath(cache_dir, key->second), store, nodes.first, nodes.second);
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef cache_hpp
+#define cache_hpp
+
+#include <forward_list>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Boost Filesystem interaction
+#define BOOST_FILESYSTEM_VERSION 3
+#define BOOST_FILESYSTEM_NO_DEPRECATED
+#include <boost/filesystem.hpp>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "types.hpp"
+#include "nodestore.hpp"
+#include "parallel.hpp"
+#include "channels.hpp"
+
+// function definitions
+std::forward_list<std::string> lookup_cache(const std::string& cache_dir, const std::forward_list<std::string>& files, int thread_no, const std::string& options, std::unordered_map<std::string, std::string>& keys, NodeStore& store);
+void store_cache(const std::string& cache_dir, const std::forward_list<std::unique_ptr<llvm::Module>>& modules, const std::unordered_map<std::string, std::string>& keys, const NodeStore& store);
+
+#endif /* cache_hpp */
@@ -0,0 +1,402 @@
+#include "channels.hpp"
+
+using namespace llvm;
+
+/**
+ The channel APIs known without any configuration. Every line describes one function:
+ `<kind> <function> <channel struct prefix> <argument>`
+
+ - kind: `send`, `recv` or `create` (a function returning a new channel)
+ - function: the demangled path of the function. A trailing `::*` also matches everything
+   nested into the function (closures, inner functions).
+ - channel struct prefix: the name of the channel struct in the IR up to the message type.
+   The message type is everything between the prefix and the last `>`. `-` for `create`.
+ - argument: the index of the argument holding the channel (not counting a struct return
+   value), or `last` for the last argument. `-` for `create`.
+ */
+static const char* default_channel_apis = R"(
+send    <std::sync::mpsc::Sender<T>>::send                              std::sync::mpsc::Sender<                        0
+send    <ipc_channel::ipc::IpcSender<T>>::send                          ipc_channel::ipc::IpcSender<                    0
+recv    <std::sync::mpsc::Receiver<T>>::recv                            std::sync::mpsc::Receiver<                      0
+recv    <std::sync::mpsc::Receiver<T>>::try_recv                        std::sync::mpsc::Receiver<                      0
+recv    <ipc_channel::ipc::IpcReceiver<T>>::recv                        ipc_channel::ipc::IpcReceiver<                  0
+recv    <ipc_channel::ipc::IpcReceiver<T>>::try_recv                    ipc_channel::ipc::IpcReceiver<                  0
+# select! takes the receiver as last argument
+recv    std::sync::mpsc::select::Select::handle::*                      std::sync::mpsc::Receiver<                      last
+
+send    <crossbeam_channel::channel::Sender<T>>::send                   crossbeam_channel::channel::Sender<             0
+send    <crossbeam_channel::channel::Sender<T>>::try_send               crossbeam_channel::channel::Sender<             0
+recv    <crossbeam_channel::channel::Receiver<T>>::recv                 crossbeam_channel::channel::Receiver<           0
+recv    <crossbeam_channel::channel::Receiver<T>>::try_recv             crossbeam_channel::channel::Receiver<           0
+
+send    <futures_channel::mpsc::Sender<T>>::try_send                    futures_channel::mpsc::Sender<                  0
+send    <futures_channel::mpsc::UnboundedSender<T>>::unbounded_send     futures_channel::mpsc::UnboundedSender<         0
+recv    <futures_channel::mpsc::Receiver<T>>::try_next                  futures_channel::mpsc::Receiver<                0
+recv    <futures_channel::mpsc::UnboundedReceiver<T>>::try_next         futures_channel::mpsc::UnboundedReceiver<       0
+
+send    <tokio::sync::mpsc::bounded::Sender<T>>::send                   tokio::sync::mpsc::bounded::Sender<             0
+send    <tokio::sync::mpsc::bounded::Sender<T>>::try_send               tokio::sync::mpsc::bounded::Sender<             0
+recv    <tokio::sync::mpsc::bounded::Receiver<T>>::recv                 tokio::sync::mpsc::bounded::Receiver<           0
+recv    <tokio::sync::mpsc::bounded::Receiver<T>>::try_recv             tokio::sync::mpsc::bounded::Receiver<           0
+send    <tokio::sync::mpsc::unbounded::UnboundedSender<T>>::send        tokio::sync::mpsc::unbounded::UnboundedSender<  0
+recv    <tokio::sync::mpsc::unbounded::UnboundedReceiver<T>>::recv      tokio::sync::mpsc::unbounded::UnboundedReceiver< 0
+
+# channel constructors, used to pair the sends and recvs of the same channel (-track-channels)
+create  std::sync::mpsc::channel                                        -                                               -
+create  std::sync::mpsc::sync_channel                                   -                                               -
+create  ipc_channel::ipc::channel                                       -                                               -
+)";
+
+// path segments are separated by a character that never appears in a decoded segment
+static const char separator = '\0';
+
+
+/**
+ Split a demangled path into its segments. Separators inside of angle brackets belong to the
+ segment, e.g. `<std::sync::mpsc::Sender<T>>::send` has the two segments
+ `<std::sync::mpsc::Sender<T>>` and `send`.
+
+ @param path The demangled path.
+ @param segments Receives the segments.
+ */
+static void splitPath(StringRef path, std::vector<std::string>& segments) {
+    segments.clear();
+
+    int depth = 0;
+    std::size_t begin = 0;
+    for (std::size_t i = 0; i < path.size(); ++i) {
+        if (path[i] == '<')
+            ++depth;
+        else if (path[i] == '>' && (i == 0 || path[i - 1] != '-'))
+            --depth;
+        else if (depth == 0 && path[i] == ':' && i + 1 < path.size() && path[i + 1] == ':') {
+            segments.push_back(path.slice(begin, i).str());
+            begin = i + 2;
+            ++i;
+        }
+    }
+    segments.push_back(path.drop_front(begin).str());
+}
+
+
+/**
+ Parse one line of a channel configuration.
+
+ @param line The line, without comments.
+ @param api Receives the channel function.
+ @param error Receives a description of the problem, if the line is invalid.
+ @return `false`, if the line is invalid.
+ */
+static bool parseApi(StringRef line, ChannelApi& api, std::string& error) {
+    // the function may contain spaces (`<T as Trait>`), so the fields are split off both ends
+    line = line.trim();
+    std::size_t kind_end = line.find_first_of(" \t");
+    StringRef kind = line.take_front(kind_end);
+    StringRef rest = kind_end == StringRef::npos ? StringRef() : line.drop_front(kind_end).trim();
+    std::size_t arg_begin = rest.find_last_of(" \t");
+    if (arg_begin == StringRef::npos) {
+        error = "expected <kind> <function> <channel struct prefix> <argument>";
+        return false;
+    }
+    StringRef argument = rest.drop_front(arg_begin + 1);
+    rest = rest.take_front(arg_begin).rtrim();
+    std::size_t prefix_begin = rest.find_last_of(" \t");
+    if (prefix_begin == StringRef::npos) {
+        error = "expected <kind> <function> <channel struct prefix> <argument>";
+        return false;
+    }
+    StringRef prefix = rest.drop_front(prefix_begin + 1);
+    StringRef function = rest.take_front(prefix_begin).trim();
+
+    if (kind == "send")
+        api.kind = SendCallee;
+    else if (kind == "recv")
+        api.kind = RecvCallee;
+    else if (kind == "create")
+        api.kind = CreateCallee;
+    else {
+        error = "unknown kind '" + kind.str() + "', expected send, recv or create";
+        return false;
+    }
+
+    // constructors have no channel argument and no channel struct
+    if (api.kind == CreateCallee) {
+        if (prefix != "-" || argument != "-") {
+            error = "expected - as channel struct prefix and argument of create";
+            return false;
+        }
+        prefix = StringRef();
+        api.argument = 0;
+    }
+    else if (argument == "last")
+        api.argument = -1;
+    else {
+        unsigned index;
+        if (argument.getAsInteger(10, index)) {
+            error = "invalid argument '" + argument.str() + "', expected a number or last";
+            return false;
+        }
+        api.argument = static_cast<int>(index);
+    }
+
+    api.function = function.str();
+    api.type_prefix = prefix.str();
+    splitPath(function, api.segments);
+    api.nested = api.segments.size() > 1 && api.segments.back() == "*";
+    if (api.nested)
+        api.segments.pop_back();
+
+    for (const std::string& segment: api.segments)
+        if (segment.empty() || segment == "*") {
+            error = "invalid function '" + api.function + "'";
+            return false;
+        }
+
+    return true;
+}
+
+
+/**
+ Parse a channel configuration and append its functions.
+
+ @param text The configuration.
+ @param origin The name of the configuration for error messages.
+ @param apis The list to extend.
+ @return `false`, if the configuration contains an invalid line.
+ */
+static bool parseConfig(StringRef text, const std::string& origin, std::vector<ChannelApi>& apis) {
+    SmallVector<StringRef, 32> lines;
+    text.split(lines, '\n');
+
+    bool valid = true;
+    for (std::size_t idx = 0; idx < lines.size(); ++idx) {
+        StringRef line = lines[idx].split('#').first.trim();
+        if (line.empty())
+            continue;
+
+        ChannelApi api;
+        std::string error;
+        if (parseApi(line, api, error))
+            apis.push_back(std::move(api));
+        else {
+            std::cerr << "[ERROR] " << origin << ":" << idx + 1 << ": " << error << std::endl;
+            valid = false;
+        }
+    }
+
+    return valid;
+}
+
+
+/**
+ All known channel functions together with the automaton recognizing them. `Result::unwrap` is
+ recognized by the same automaton, so a symbol is classified in a single pass.
+ */
+struct ChannelRegistry {
+    std::vector<ChannelApi> apis;
+    ChannelApi unwrap;
+    AhoCorasick automaton;
+
+    ChannelRegistry() {
+        parseConfig(default_channel_apis, "built-in channel APIs", apis);
+        unwrap = ChannelApi {UnwrapCallee, "<core::result::Result<T, E>>::unwrap::*", {"<core::result::Result<T, E>>", "unwrap"}, true, "", 0};
+        compile();
+    }
+
+    // every pattern starts and ends at a segment boundary: <sep>segment<sep>segment<sep>
+    static std::string patternText(const ChannelApi& api) {
+        std::string text(1, separator);
+        for (const std::string& segment: api.segments) {
+            text.append(segment);
+            text.push_back(separator);
+        }
+        return text;
+    }
+
+    void compile() {
+        automaton = AhoCorasick();
+        for (std::size_t idx = 0; idx < apis.size(); ++idx)
+            automaton.addPattern(patternText(apis[idx]), static_cast<unsigned>(idx));
+        // unwrap comes last, so channel functions win if both match
+        automaton.addPattern(patternText(unwrap), static_cast<unsigned>(apis.size()));
+        automaton.compile();
+    }
+};
+
+
+static ChannelRegistry& registry() {
+    static ChannelRegistry instance;
+    return instance;
+}
+
+
+/**
+ Load additional channel APIs from a configuration file (see `default_channel_apis` for the
+ format). Has to be called before the first function is classified.
+
+ @param path The path of the configuration file.
+ @return `false`, if the file could not be read or contains invalid lines.
+ */
+bool loadChannelConfig(const std::string& path) {
+    std::ifstream config(path);
+    if (!config.good()) {
+        std::cerr << "[ERROR] Could not read the channel configuration " << path << std::endl;
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(config)), std::istreambuf_iterator<char>());
+
+    std::vector<ChannelApi> apis {};
+    if (!parseConfig(text, path, apis))
+        return false;
+
+    ChannelRegistry& reg = registry();
+    reg.apis.insert(reg.apis.end(), apis.begin(), apis.end());
+    reg.compile();
+    return true;
+}
+
+
+const std::vector<ChannelApi>& channelApis() {
+    return registry().apis;
+}
+
+
+/**
+ Describe the registered channel APIs in a single string. Results computed with a different
+ set of APIs differ, so the string becomes part of the cache key.
+
+ @return The description of all registered APIs.
+ */
+std::string channelConfigTag() {
+    std::string tag;
+    for (const ChannelApi& api: channelApis()) {
+        tag.append(api.kind == SendCallee ? "send\t" : api.kind == RecvCallee ? "recv\t" : "create\t");
+        tag.append(api.function + "\t" + api.type_prefix + "\t" + std::to_string(api.argument) + "\n");
+    }
+    return tag;
+}
+
+
+/**
+ Find the channel function (or `Result::unwrap`) a symbol belongs to. The decoded path segments
+ are fed through the automaton once, independent of the number of registered APIs. A function
+ pattern has to match the end of the path, nested patterns may be followed by more segments.
+ The function itself has to be followed by the hash, just like `<impl>::<method>::h...` in the
+ demangled name.
+
+ @param symbol The mangled name of the function, split into segments.
+ @return The matching entry, or `nullptr`. If several entries match, the first one wins.
+ */
+const ChannelApi* matchChannelApi(const RustSymbol& symbol) {
+    const ChannelRegistry& reg = registry();
+    const AhoCorasick& automaton = reg.automaton;
+
+    unsigned best = std::numeric_limits<unsigned>::max();
+    unsigned state = automaton.next(automaton.start(), separator);
+    for (std::size_t i = 0; i < symbol.size(); ++i) {
+        RustSegmentDecoder decoder(symbol[i]);
+        char c;
+        while (decoder.next(c))
+            state = automaton.next(state, c);
+        state = automaton.next(state, separator);
+
+        bool at_end = i + 1 == symbol.size();
+        for (unsigned idx: automaton.matches(state)) {
+            const ChannelApi& api = idx < reg.apis.size() ? reg.apis[idx] : reg.unwrap;
+            bool matches = api.nested ? (!at_end || symbol.hasHash()) : (at_end && symbol.hasHash());
+            if (matches && idx < best)
+                best = idx;
+        }
+    }
+
+    if (best < reg.apis.size())
+        return &reg.apis[best];
+    if (best == reg.apis.size())
+        return &reg.unwrap;
+    return nullptr;
+}
+
+
+/**
+ Extract the message type from the name of a channel struct, e.g. `u32` from
+ `std::sync::mpsc::Sender<u32>`.
+
+ @param api The channel function the struct was passed to.
+ @param struct_name The name of the channel struct.
+ @param type Receives the interned message type.
+ @return `false`, if the struct does not belong to the channel API.
+ */
+bool getMessageType(const ChannelApi& api, StringRef struct_name, StringId& type) {
+    if (api.type_prefix.empty() || !struct_name.startswith(api.type_prefix))
+        return false;
+
+    StringRef message = struct_name.drop_front(api.type_prefix.size());
+    type = intern(message.substr(0, message.rfind('>')));
+    return true;
+}
+
+
+// the inverse of `RustSegmentDecoder`
+static std::string encodeSegment(StringRef decoded) {
+    std::string encoded;
+    for (std::size_t i = 0; i < decoded.size(); ++i) {
+        char c = decoded[i];
+        if (c == ':' && i + 1 < decoded.size() && decoded[i + 1] == ':') {
+            encoded.append("..");
+            ++i;
+        }
+        else if (isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.')
+            encoded.push_back(c);
+        else if (c == '<') encoded.append("$LT$");
+        else if (c == '>') encoded.append("$GT$");
+        else if (c == ',') encoded.append("$C$");
+        else if (c == '&') encoded.append("$RF$");
+        else if (c == '*') encoded.append("$BP$");
+        else if (c == '@') encoded.append("$SP$");
+        else if (c == '(') encoded.append("$LP$");
+        else if (c == ')') encoded.append("$RP$");
+        else {
+            char code[8];
+            snprintf(code, sizeof(code), "$u%x$", static_cast<unsigned char>(c));
+            encoded.append(code);
+        }
+    }
+
+    // rustc prefixes segments starting with an escape sequence with an underscore
+    if (!encoded.empty() && encoded.front() == '$')
+        encoded.insert(0, "_");
+    return encoded;
+}
+
+
+/**
+ Get mangled fragments of the registered send and recv functions. A symbol of one of these
+ functions always contains the fragment of its API: the (encoded) second to last segment of the
+ function, followed by the length-prefixed last segment, e.g. for `<std::sync::mpsc::Sender<T>>::send`:
+ `$LT$std..sync..mpsc..Sender$LT$T$GT$$GT$4send`
+
+ @return The fragments, without duplicates.
+ */
+std::vector<std::string> channelSymbolFragments() {
+    std::vector<std::string> fragments {};
+    for (const ChannelApi& api: channelApis()) {
+        // files that only create channels have nothing to analyze
+        if (api.kind == CreateCallee)
+            continue;
+
+        std::string fragment;
+        std::size_t n = api.segments.size();
+        if (n >= 2) {
+            // the leading underscore is left out, the segment may be part of a longer one
+            fragment = StringRef(encodeSegment(api.segments[n - 2])).ltrim('_').str();
+            std::string last = encodeSegment(api.segments[n - 1]);
+            fragment.append(std::to_string(last.size()) + last);
+        }
+        else
+            fragment = encodeSegment(api.segments[0]);
+
+        if (std::find(fragments.begin(), fragments.end(), fragment) == fragments.end())
+            fragments.push_back(std::move(fragment));
+    }
+    return fragments;
+}
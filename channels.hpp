@@ -0,0 +1,48 @@
+#ifndef channels_hpp
+#define channels_hpp
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include "ahocorasick.hpp"
+#include "interner.hpp"
+#include "rustsymbol.hpp"
+
+enum CalleeKind {
+    OtherCallee,    ///< Any function not relevant for message passing.
+    SendCallee,     ///< A `send` function of a channel.
+    RecvCallee,     ///< A `recv` (or `try_recv`, select handle) function of a channel.
+    CreateCallee,   ///< A function creating a channel, e.g. `std::sync::mpsc::channel`.
+    UnwrapCallee    ///< `Result::unwrap`.
+};
+
+/**
+ A function of a channel API, e.g. `<std::sync::mpsc::Sender<T>>::send`.
+ */
+struct ChannelApi {
+    CalleeKind kind;
+    std::string function;               ///< The function pattern as written in the configuration.
+    std::vector<std::string> segments;  ///< The (decoded) path segments of the pattern.
+    bool nested;                        ///< The pattern ends with `::*` and matches nested items, too.
+    std::string type_prefix;            ///< The channel struct up to the message type, e.g. `std::sync::mpsc::Sender<`.
+    int argument;                       ///< Index of the channel argument (not counting a struct return), -1 for the last argument.
+};
+
+bool loadChannelConfig(const std::string& path);
+const std::vector<ChannelApi>& channelApis();
+std::string channelConfigTag();
+const ChannelApi* matchChannelApi(const RustSymbol& symbol);
+bool getMessageType(const ChannelApi& api, llvm::StringRef struct_name, StringId& type);
+std::vector<std::string> channelSymbolFragments();
+
+#endif /* channels_hpp */
@@ -0,0 +1,402 @@
+#include "channeltracking.hpp"
+
+using namespace llvm;
+
+
+// the creation sites a value may hold a channel of: none (yet), exactly one (its index) or several
+static const unsigned NoSite = std::numeric_limits<unsigned>::max();
+static const unsigned ManySites = NoSite - 1;
+
+static unsigned joinSites(unsigned a, unsigned b) {
+    if (a == NoSite)
+        return b;
+    if (b == NoSite || a == b)
+        return a;
+    return ManySites;
+}
+
+
+/// A field of a struct type, e.g. a captured variable of a closure.
+typedef std::pair<StructType*, unsigned> StructField;
+
+
+/**
+ Get the struct field a GEP addresses, like field 1 of `%closure` for
+ `getelementptr %closure, %closure* %env, i64 0, i32 1`.
+
+ @return `false`, if the GEP does not address a constant field of a struct.
+ */
+static bool getStructField(const GetElementPtrInst* gep, StructField& field) {
+    if (gep->getNumIndices() < 2)
+        return false;
+
+    StructType* type = dyn_cast<StructType>(gep->getSourceElementType());
+    ConstantInt* first = dyn_cast<ConstantInt>(gep->getOperand(1));
+    ConstantInt* second = dyn_cast<ConstantInt>(gep->getOperand(2));
+    if (!type || !first || !second || !first->isZero())
+        return false;
+
+    field = std::make_pair(type, static_cast<unsigned>(second->getZExtValue()));
+    return true;
+}
+
+
+// unlike `stripPointerCasts`, this keeps GEPs to the first field of a struct
+static const Value* stripBitCasts(const Value* value) {
+    while (const BitCastOperator* cast = dyn_cast<BitCastOperator>(value))
+        value = cast->getOperand(0);
+    return value;
+}
+
+
+// the channel is not followed into `std`, `core` and `alloc`, only into the analyzed program
+static bool isLibraryFunction(const Function* fn) {
+    RustSymbol symbol;
+    if (!fn->hasName() || !RustSymbol::parse(fn->getName(), symbol) || symbol.size() == 0)
+        return false;
+
+    // the crate is the start of the first segment, impls start with `<`, e.g. `<std::sync::mpsc::Sender<T>>`
+    RustSegmentDecoder decoder(symbol[0]);
+    std::string crate;
+    char c;
+    while (crate.size() < 8 && decoder.next(c) && c != ':')
+        if (c != '<')
+            crate.push_back(c);
+
+    return crate == "std" || crate == "core" || crate == "alloc";
+}
+
+
+static const Function* getCalledFunction(const Instruction* call) {
+    if (const CallInst* ci = dyn_cast<CallInst>(call))
+        return ci->getCalledFunction();
+    if (const InvokeInst* ii = dyn_cast<InvokeInst>(call))
+        return ii->getCalledFunction();
+    return nullptr;
+}
+
+
+// the argument `idx` of a call, `nullptr` if there is none
+static const Value* getCallArgument(const Instruction* call, unsigned idx) {
+    if (const CallInst* ci = dyn_cast<CallInst>(call))
+        return idx < ci->getNumArgOperands() ? ci->getArgOperand(idx) : nullptr;
+    if (const InvokeInst* ii = dyn_cast<InvokeInst>(call))
+        return idx < ii->getNumArgOperands() ? ii->getArgOperand(idx) : nullptr;
+    return nullptr;
+}
+
+
+/**
+ Follows the channels from their creation sites through a module. A value holding a channel
+ (the pointer to a `Sender`/`Receiver`, or to the pair returned by the constructor) passes it on
+ to casts, GEPs, loads, PHIs, the memory it is stored or copied to, the parameters of the called
+ functions of the program and the results of `clone` and `unwrap`. Struct fields are tracked per
+ struct type, which carries the channels captured by a closure (e.g. for `thread::spawn`) into
+ the closure's body.
+
+ The propagation starts at the creation sites only, so a value none of them reaches may still
+ hold any channel, e.g. one received from a channel or taken out of a collection. Wherever such an
+ untracked value meets a tracked one (PHIs, selects, parameters, memory), the tracked value may
+ hold either and becomes ambiguous (`checkSources`), so a channel is only assigned if every
+ source of a value is tracked.
+ */
+struct ChannelTracker {
+    std::unordered_map<const Value*, unsigned> sites;
+    std::map<StructField, unsigned> field_sites;
+    std::map<StructField, std::vector<const GetElementPtrInst*>> field_geps;
+    std::unordered_map<const Function*, std::vector<const Instruction*>> callers;
+    std::vector<const Value*> worklist;
+
+    unsigned siteOf(const Value* value) const {
+        auto known = sites.find(value);
+        return known == sites.end() ? NoSite : known->second;
+    }
+
+    void flow(const Value* value, unsigned site) {
+        unsigned old_site = siteOf(value);
+        unsigned new_site = joinSites(old_site, site);
+        if (new_site == old_site)
+            return;
+
+        sites[value] = new_site;
+        worklist.push_back(value);
+    }
+
+    // the channel is written to the memory `ptr` points to
+    void flowInto(const Value* ptr, unsigned site) {
+        flow(ptr, site);
+        const Value* base = stripBitCasts(ptr);
+        flow(base, site);
+
+        StructField field;
+        const GetElementPtrInst* gep = dyn_cast<GetElementPtrInst>(base);
+        if (!gep || !getStructField(gep, field))
+            return;
+
+        // literal struct types are shared by unrelated values of the same layout
+        if (field.first->isLiteral())
+            site = ManySites;
+
+        // every read of the field may see the channel
+        unsigned old_site = field_sites.count(field) ? field_sites[field] : NoSite;
+        unsigned new_site = joinSites(old_site, site);
+        if (new_site == old_site)
+            return;
+
+        field_sites[field] = new_site;
+        for (const GetElementPtrInst* read: field_geps[field])
+            flow(read, new_site);
+    }
+
+    // the channel is returned by the call, either directly or through its struct return argument
+    template<typename CallType>
+    void flowResult(const CallType* call, unsigned site) {
+        if (call->hasStructRetAttr())
+            flowInto(call->getArgOperand(0), site);
+        else if (!call->getType()->isVoidTy())
+            flow(call, site);
+    }
+
+    template<typename CallType>
+    void flowCall(const CallType* call, const Value* value, unsigned site) {
+        const Function* callee = call->getCalledFunction();
+        if (!callee)
+            return;
+
+        // sends and recvs are the end of the road, unwrapping the result of a constructor
+        // (`ipc::channel`) yields the channel
+        CalleeKind kind = classifyCallee(callee).kind;
+        if (kind != OtherCallee && kind != UnwrapCallee)
+            return;
+
+        Type* type = value->getType();
+        Type* result = call->hasStructRetAttr() ? call->getArgOperand(0)->getType() : call->getType();
+        for (unsigned idx = 0; idx < call->getNumArgOperands(); ++idx) {
+            // a call writing its result to the channel's memory does not read the channel
+            if (call->getArgOperand(idx) != value || (idx == 0 && call->hasStructRetAttr()))
+                continue;
+
+            if (kind == UnwrapCallee)
+                flowResult(call, site);
+            else if (!callee->isDeclaration() && !isLibraryFunction(callee)) {
+                if (idx < callee->arg_size())
+                    flow(&*std::next(callee->arg_begin(), idx), site);
+            }
+            // library functions returning another endpoint, i.e. `Sender::clone`
+            else if (result == type || (type->isPointerTy() && result == type->getPointerElementType()))
+                flowResult(call, site);
+        }
+    }
+
+    void visit(const Value* value) {
+        unsigned site = siteOf(value);
+
+        // whatever a function writes to its struct return argument, its callers receive
+        if (const Argument* arg = dyn_cast<Argument>(value))
+            if (arg->hasStructRetAttr())
+                for (const Instruction* call: callers[arg->getParent()])
+                    flowInto(call->getOperand(0), site);
+
+        for (const User* user: value->users()) {
+            if (isa<CastInst>(user) || isa<PHINode>(user) || isa<LoadInst>(user))
+                flow(user, site);
+            else if (const GetElementPtrInst* gep = dyn_cast<GetElementPtrInst>(user)) {
+                if (gep->getPointerOperand() == value)
+                    flow(gep, site);
+            }
+            else if (const SelectInst* select = dyn_cast<SelectInst>(user)) {
+                if (select->getCondition() != value)
+                    flow(select, site);
+            }
+            else if (const StoreInst* store = dyn_cast<StoreInst>(user)) {
+                if (store->getValueOperand() == value)
+                    flowInto(store->getPointerOperand(), site);
+            }
+            else if (const MemTransferInst* copy = dyn_cast<MemTransferInst>(user)) {
+                if (copy->getRawSource() == value)
+                    flowInto(copy->getRawDest(), site);
+            }
+            else if (const CallInst* ci = dyn_cast<CallInst>(user))
+                flowCall(ci, value, site);
+            else if (const InvokeInst* ii = dyn_cast<InvokeInst>(user))
+                flowCall(ii, value, site);
+            else if (const ReturnInst* ret = dyn_cast<ReturnInst>(user))
+                for (const Instruction* call: callers[ret->getFunction()])
+                    flow(call, site);
+        }
+    }
+
+    // whether the value holds the channel of a single creation site
+    bool isTracked(const Value* value) const {
+        return siteOf(value) < ManySites || siteOf(stripBitCasts(value)) < ManySites;
+    }
+
+    // no creation site reaches the value, it may hold any channel (constants hold none)
+    bool isUntracked(const Value* value) const {
+        return !isa<Constant>(value) && siteOf(value) == NoSite && siteOf(stripBitCasts(value)) == NoSite;
+    }
+
+    // a call writing its struct return to the memory of a channel, without a channel known to flow into it
+    void checkResult(const Instruction* call) {
+        const Value* dest = getCallArgument(call, 0);
+        bool sret = isa<CallInst>(call) ? cast<CallInst>(call)->hasStructRetAttr() : cast<InvokeInst>(call)->hasStructRetAttr();
+        if (!sret || !dest || !isTracked(dest))
+            return;
+
+        // creation sites are tracked, the functions of the program are followed
+        const Function* callee = getCalledFunction(call);
+        if (callee && (classifyCallee(callee).kind == CreateCallee || (!callee->isDeclaration() && !isLibraryFunction(callee))))
+            return;
+        // `clone` or `unwrap` of a tracked channel
+        for (unsigned idx = 1; getCallArgument(call, idx); ++idx)
+            if (isTracked(getCallArgument(call, idx)))
+                return;
+
+        flowInto(dest, ManySites);
+    }
+
+    /**
+     Make the tracked values of a function ambiguous that an untracked value flows into as well.
+     Has to be repeated (with `run`) until nothing changes.
+     */
+    void checkSources(const Function& fn) {
+        // the callers of externally visible or address-taken functions are not all known
+        bool all_callers = fn.hasLocalLinkage() && !fn.hasAddressTaken();
+        for (const Argument& arg: fn.args()) {
+            if (arg.hasStructRetAttr() || siteOf(&arg) >= ManySites)
+                continue;
+
+            bool untracked = !all_callers;
+            for (const Instruction* call: callers[&fn]) {
+                const Value* actual = getCallArgument(call, arg.getArgNo());
+                untracked = untracked || !actual || isUntracked(actual);
+            }
+            if (untracked)
+                flow(&arg, ManySites);
+        }
+
+        for (const BasicBlock& bb: fn.getBasicBlockList())
+            for (const Instruction& inst: bb.getInstList()) {
+                if (const PHINode* phi = dyn_cast<PHINode>(&inst)) {
+                    if (siteOf(phi) < ManySites && std::any_of(phi->incoming_values().begin(), phi->incoming_values().end(), [&](const Value* incoming) { return isUntracked(incoming); }))
+                        flow(phi, ManySites);
+                }
+                else if (const SelectInst* select = dyn_cast<SelectInst>(&inst)) {
+                    if (siteOf(select) < ManySites && (isUntracked(select->getTrueValue()) || isUntracked(select->getFalseValue())))
+                        flow(select, ManySites);
+                }
+                else if (const StoreInst* store = dyn_cast<StoreInst>(&inst)) {
+                    if (isTracked(store->getPointerOperand()) && isUntracked(store->getValueOperand()))
+                        flowInto(store->getPointerOperand(), ManySites);
+                }
+                else if (const MemTransferInst* copy = dyn_cast<MemTransferInst>(&inst)) {
+                    if (isTracked(copy->getRawDest()) && isUntracked(copy->getRawSource()))
+                        flowInto(copy->getRawDest(), ManySites);
+                }
+                else if (isa<CallInst>(&inst) || isa<InvokeInst>(&inst))
+                    checkResult(&inst);
+            }
+    }
+
+    /// @return `true`, if any value has changed.
+    bool run() {
+        bool changed = !worklist.empty();
+        while (!worklist.empty()) {
+            const Value* value = worklist.back();
+            worklist.pop_back();
+            visit(value);
+        }
+        return changed;
+    }
+};
+
+
+/**
+ Get the key identifying a channel by its creation site.
+
+ @param create The call of the channel constructor.
+ @param ordinal The number of the creation site within the module.
+ @return The interned `namespace:line`.
+ */
+static StringId getSiteKey(const Instruction* create, unsigned ordinal) {
+    std::string key = internedString(getNamespace(create)).str() + ":";
+    unsigned line = getLine(create);
+    // without debug information the line cannot tell the creation sites of a file apart
+    if (line)
+        key += std::to_string(line);
+    else
+        key += getFunctionName(create).str() + "#" + std::to_string(ordinal);
+    return intern(key);
+}
+
+
+/**
+ Find the channel every send and recv of a module operates on. The calls of the channel
+ constructors (`create` entries of the channel configuration) are followed to the sends and
+ recvs (see `ChannelTracker`). A node is only assigned a channel if exactly one creation site
+ and no untracked value reaches it, all others keep `NoChannel` and are matched by their type.
+
+ @param module The module, has to be materialized completely.
+ @param store The nodes, the ones from `first_node` on belong to the module.
+ @param first_node The first node of the module.
+ @return The number of nodes whose channel has been found.
+ */
+unsigned resolveChannels(Module& module, NodeStore& store, NodeId first_node) {
+    ChannelTracker tracker {};
+    std::vector<const Instruction*> creations {};
+
+    for (Function& func: module.getFunctionList())
+        for (BasicBlock& bb: func.getBasicBlockList())
+            for (Instruction& inst: bb.getInstList()) {
+                StructField field;
+                if (GetElementPtrInst* gep = dyn_cast<GetElementPtrInst>(&inst)) {
+                    if (getStructField(gep, field))
+                        tracker.field_geps[field].push_back(gep);
+                }
+                else if (const Function* callee = getCalledFunction(&inst)) {
+                    tracker.callers[callee].push_back(&inst);
+                    if (classifyCallee(callee).kind == CreateCallee)
+                        creations.push_back(&inst);
+                }
+            }
+
+    std::vector<StringId> site_keys {};
+    for (const Instruction* create: creations) {
+        unsigned site = static_cast<unsigned>(site_keys.size());
+        site_keys.push_back(getSiteKey(create, site));
+        if (const CallInst* ci = dyn_cast<CallInst>(create))
+            tracker.flowResult(ci, site);
+        else
+            tracker.flowResult(cast<InvokeInst>(create), site);
+    }
+    tracker.run();
+
+    // the untracked sources only make values ambiguous, so this ends
+    do {
+        for (Function& func: module.getFunctionList())
+            tracker.checkSources(func);
+    } while (tracker.run());
+
+    unsigned resolved = 0;
+    for (NodeId id = first_node; id < store.size(); ++id) {
+        MessagingNode& node = store[id];
+        const Function* callee = node.instr ? getCalledFunction(node.instr) : nullptr;
+        if (!callee || node.instr->getModule() != &module)
+            continue;
+
+        const CalleeInfo& info = classifyCallee(callee);
+        Value* channel_arg = info.api ? getChannelArgument(node.instr, *info.api) : nullptr;
+        if (!channel_arg)
+            continue;
+
+        unsigned site = tracker.siteOf(channel_arg);
+        if (site == NoSite)
+            site = tracker.siteOf(stripBitCasts(channel_arg));
+        if (site < ManySites) {
+            node.channel = site_keys[site];
+            ++resolved;
+        }
+    }
+
+    return resolved;
+}
@@ -0,0 +1,29 @@
+#ifndef channeltracking_hpp
+#define channeltracking_hpp
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Support/Casting.h"
+
+#include "types.hpp"
+#include "nodestore.hpp"
+#include "properties.hpp"
+#include "rustsymbol.hpp"
+
+// function definitions
+unsigned resolveChannels(llvm::Module& module, NodeStore& store, NodeId first_node);
+
+#endif /* channeltracking_hpp */
@@ -0,0 +1,321 @@
+#include "dataflow.hpp"
+
+using namespace llvm;
+
+
+// more values than this are not worth listing, the set becomes `top`
+static const std::size_t MaxValues = 16;
+
+
+/**
+ Add the values of another set.
+
+ @return `true`, if the set has changed.
+ */
+bool ValueSet::join(const ValueSet& other) {
+    if (top || (!other.top && other.values.empty()))
+        return false;
+
+    if (!other.top) {
+        std::vector<long long> merged {};
+        std::set_union(values.begin(), values.end(), other.values.begin(), other.values.end(), std::back_inserter(merged));
+        if (merged.size() == values.size())
+            return false;
+        if (merged.size() <= MaxValues) {
+            values = std::move(merged);
+            return true;
+        }
+    }
+
+    top = true;
+    values.clear();
+    return true;
+}
+
+
+// the message is moved into the send and dropped in place, neither of them changes its content
+template<typename CallType>
+static bool isReadingCall(const CallType* call, const Value* ptr) {
+    const Function* callee = call->getCalledFunction();
+    if (!callee || (call->hasStructRetAttr() && call->getArgOperand(0) == ptr))
+        return false;
+
+    return classifyCallee(callee).kind == SendCallee || callee->getName().find("drop_in_place") != StringRef::npos;
+}
+
+
+/**
+ Check whether an alloca is only accessed directly, through loads, stores, memcpys and casts or
+ constant GEPs of its address. Nothing else can write to it then.
+ */
+static bool isLocal(const AllocaInst* alloca) {
+    std::vector<const Value*> pointers {alloca};
+    while (!pointers.empty()) {
+        const Value* ptr = pointers.back();
+        pointers.pop_back();
+
+        for (const User* user: ptr->users()) {
+            if (isa<BitCastInst>(user))
+                pointers.push_back(user);
+            else if (const GetElementPtrInst* gep = dyn_cast<GetElementPtrInst>(user)) {
+                if (!gep->isInBounds() || !gep->hasAllConstantIndices())
+                    return false;
+                pointers.push_back(gep);
+            }
+            else if (const StoreInst* store = dyn_cast<StoreInst>(user)) {
+                if (store->getValueOperand() == ptr)
+                    return false;
+            }
+            else if (isa<LoadInst>(user) || isa<MemTransferInst>(user) || isa<DbgInfoIntrinsic>(user))
+                continue;
+            else if (const IntrinsicInst* intrinsic = dyn_cast<IntrinsicInst>(user)) {
+                if (intrinsic->getIntrinsicID() != Intrinsic::lifetime_start && intrinsic->getIntrinsicID() != Intrinsic::lifetime_end)
+                    return false;
+            }
+            else if (const CallInst* ci = dyn_cast<CallInst>(user)) {
+                if (!isReadingCall(ci, ptr))
+                    return false;
+            }
+            else if (const InvokeInst* ii = dyn_cast<InvokeInst>(user)) {
+                if (!isReadingCall(ii, ptr))
+                    return false;
+            }
+            else
+                return false;
+        }
+    }
+    return true;
+}
+
+
+// the values of these instructions are computed by the analysis, all others are unknown
+static bool isTracked(const Value* value) {
+    return isa<LoadInst>(value) || isa<PHINode>(value) || isa<SelectInst>(value) \
+        || isa<ZExtInst>(value) || isa<SExtInst>(value) || isa<TruncInst>(value);
+}
+
+
+/**
+ Run the analysis on a function.
+
+ @param fn The function, its body has to be materialized.
+ */
+SentValueFlow::SentValueFlow(Function& fn) : layout(fn.getParent()->getDataLayout()) {
+    for (BasicBlock& bb: fn.getBasicBlockList())
+        for (Instruction& inst: bb.getInstList())
+            if (AllocaInst* alloca = dyn_cast<AllocaInst>(&inst))
+                if (isLocal(alloca))
+                    allocas[alloca] = Slots {{}, false};
+
+    // the loads and memcpys have to be evaluated again when an alloca they read changes
+    for (BasicBlock& bb: fn.getBasicBlockList())
+        for (Instruction& inst: bb.getInstList()) {
+            int64_t offset;
+            const AllocaInst* alloca = nullptr;
+            if (LoadInst* load = dyn_cast<LoadInst>(&inst))
+                alloca = getSlot(load->getPointerOperand(), offset);
+            else if (MemTransferInst* copy = dyn_cast<MemTransferInst>(&inst))
+                alloca = getSlot(copy->getRawSource(), offset);
+            if (alloca)
+                readers[alloca].push_back(&inst);
+
+            worklist.push_back(&inst);
+        }
+
+    // evaluate in program order first, most values are final then
+    std::reverse(worklist.begin(), worklist.end());
+    while (!worklist.empty()) {
+        const Instruction* inst = worklist.back();
+        worklist.pop_back();
+        evaluate(inst);
+    }
+}
+
+
+/**
+ Get the set of values a sent message may have. For a message passed by reference, this is the
+ content of the slot at the start of the memory it points to (where the discriminant of an enum
+ is stored), whatever its width.
+
+ @param message The message argument of the send.
+ @return The values, `top` or empty if they are unknown.
+ */
+ValueSet SentValueFlow::valuesOf(const Value* message) const {
+    if (message->getType()->isPointerTy())
+        return read(message, 0);
+    return scalarOf(message);
+}
+
+
+/**
+ Get the local alloca a pointer points into.
+
+ @param ptr The pointer.
+ @param offset Receives the byte offset into the alloca.
+ @return The alloca, or `nullptr` if the pointer does not point to a known offset of a local alloca.
+ */
+const AllocaInst* SentValueFlow::getSlot(const Value* ptr, int64_t& offset) const {
+    APInt accumulated(layout.getPointerTypeSizeInBits(ptr->getType()), 0);
+    const AllocaInst* alloca = dyn_cast<AllocaInst>(ptr->stripAndAccumulateInBoundsConstantOffsets(layout, accumulated));
+    if (!alloca || allocas.find(alloca) == allocas.end())
+        return nullptr;
+
+    offset = accumulated.getSExtValue();
+    return alloca;
+}
+
+
+ValueSet SentValueFlow::scalarOf(const Value* value) const {
+    if (const ConstantInt* constant = dyn_cast<ConstantInt>(value)) {
+        if (constant->getBitWidth() <= 64)
+            return ValueSet {{constant->getSExtValue()}, false};
+    }
+    else if (isa<UndefValue>(value))
+        return ValueSet {{}, false};
+    else if (isTracked(value)) {
+        auto known = scalars.find(value);
+        return known == scalars.end() ? ValueSet {{}, false} : known->second;
+    }
+    return ValueSet {{}, true};
+}
+
+
+// the first slot overlapping the bytes from `offset` on, given the first slot starting there or later
+template<typename Iterator>
+static Iterator findOverlap(Iterator begin, Iterator slot, int64_t offset) {
+    if (slot != begin && std::prev(slot)->first + std::prev(slot)->second.width > offset)
+        return std::prev(slot);
+    return slot;
+}
+
+
+/**
+ Get the values of `width` bytes at a pointer, `top` if they only partly overlap a slot.
+
+ @param ptr The pointer.
+ @param width The number of bytes, `0` to read the slot at the pointer whatever its width.
+ @return The values, empty if nothing has been written there.
+ */
+ValueSet SentValueFlow::read(const Value* ptr, int64_t width) const {
+    int64_t offset;
+    const AllocaInst* alloca = getSlot(ptr, offset);
+    if (!alloca)
+        return ValueSet {{}, true};
+
+    const Slots& slots = allocas.at(alloca);
+    if (slots.top)
+        return ValueSet {{}, true};
+
+    auto slot = findOverlap(slots.offsets.begin(), slots.offsets.lower_bound(offset), offset);
+    if (slot == slots.offsets.end() || slot->first >= offset + std::max<int64_t>(width, 1))
+        return ValueSet {{}, false};
+    if (slot->first != offset || (width != 0 && slot->second.width != width))
+        return ValueSet {{}, true};
+    return slot->second.values;
+}
+
+
+/**
+ Add values to `width` bytes of an alloca. If the bytes overlap slots of another width, these
+ are merged into one slot of unknown values.
+ */
+void SentValueFlow::write(const AllocaInst* alloca, int64_t offset, int64_t width, const ValueSet& values) {
+    Slots& slots = allocas.at(alloca);
+    if (slots.top || width <= 0)
+        return;
+
+    auto first = findOverlap(slots.offsets.begin(), slots.offsets.lower_bound(offset), offset);
+    auto last = slots.offsets.lower_bound(offset + width);
+    if (first == last)
+        slots.offsets[offset] = Slot {width, values};
+    else if (std::next(first) == last && first->first == offset && first->second.width == width) {
+        if (!first->second.values.join(values))
+            return;
+    }
+    else {
+        int64_t begin = std::min(offset, first->first);
+        int64_t end = offset + width;
+        for (auto slot = first; slot != last; ++slot)
+            end = std::max(end, slot->first + slot->second.width);
+        // the bytes belong to a slot of unknown values already
+        if (std::next(first) == last && first->first == begin && first->second.width == end - begin && first->second.values.top)
+            return;
+
+        slots.offsets.erase(first, last);
+        slots.offsets[begin] = Slot {end - begin, ValueSet {{}, true}};
+    }
+
+    worklist.insert(worklist.end(), readers[alloca].begin(), readers[alloca].end());
+}
+
+
+// the whole alloca may hold anything, e.g. after copying unknown memory into it
+void SentValueFlow::clobber(const AllocaInst* alloca) {
+    Slots& slots = allocas.at(alloca);
+    if (slots.top)
+        return;
+
+    slots.top = true;
+    slots.offsets.clear();
+    worklist.insert(worklist.end(), readers[alloca].begin(), readers[alloca].end());
+}
+
+
+void SentValueFlow::update(const Instruction* inst, const ValueSet& values) {
+    if (!scalars[inst].join(values))
+        return;
+
+    for (const User* user: inst->users())
+        if (const Instruction* user_inst = dyn_cast<Instruction>(user))
+            worklist.push_back(user_inst);
+}
+
+
+void SentValueFlow::evaluate(const Instruction* inst) {
+    if (const LoadInst* load = dyn_cast<LoadInst>(inst))
+        update(load, read(load->getPointerOperand(), static_cast<int64_t>(layout.getTypeStoreSize(load->getType()))));
+    else if (const PHINode* phi = dyn_cast<PHINode>(inst)) {
+        ValueSet values {{}, false};
+        for (const Value* incoming: phi->incoming_values())
+            values.join(scalarOf(incoming));
+        update(phi, values);
+    }
+    else if (const SelectInst* select = dyn_cast<SelectInst>(inst)) {
+        ValueSet values = scalarOf(select->getTrueValue());
+        values.join(scalarOf(select->getFalseValue()));
+        update(select, values);
+    }
+    else if (isTracked(inst))
+        // integer casts, the discriminants are small enough to survive them
+        update(inst, scalarOf(inst->getOperand(0)));
+    else if (const StoreInst* store = dyn_cast<StoreInst>(inst)) {
+        int64_t offset;
+        if (const AllocaInst* alloca = getSlot(store->getPointerOperand(), offset))
+            write(alloca, offset, static_cast<int64_t>(layout.getTypeStoreSize(store->getValueOperand()->getType())), scalarOf(store->getValueOperand()));
+    }
+    else if (const MemTransferInst* copy = dyn_cast<MemTransferInst>(inst)) {
+        int64_t dest_offset, source_offset;
+        const AllocaInst* dest = getSlot(copy->getRawDest(), dest_offset);
+        if (!dest)
+            return;
+
+        const AllocaInst* source = getSlot(copy->getRawSource(), source_offset);
+        const ConstantInt* length = dyn_cast<ConstantInt>(copy->getLength());
+        if (!source || !length || allocas.at(source).top) {
+            clobber(dest);
+            return;
+        }
+
+        // the slots of the copied range, at their offsets in the destination
+        const std::map<int64_t, Slot>& offsets = allocas.at(source).offsets;
+        int64_t end = source_offset + static_cast<int64_t>(length->getZExtValue());
+        std::vector<std::pair<int64_t, Slot>> copied(findOverlap(offsets.begin(), offsets.lower_bound(source_offset), source_offset), offsets.lower_bound(end));
+        for (const std::pair<int64_t, Slot>& slot: copied) {
+            int64_t begin = std::max(slot.first, source_offset);
+            int64_t slot_end = std::min(slot.first + slot.second.width, end);
+            // the part of a slot cut off by the range is of unknown value
+            bool whole = begin == slot.first && slot_end == slot.first + slot.second.width;
+            write(dest, dest_offset + begin - source_offset, slot_end - begin, whole ? slot.second.values : ValueSet {{}, true});
+        }
+    }
+}
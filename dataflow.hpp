@@ -0,0 +1,77 @@
+#ifndef dataflow_hpp
+#define dataflow_hpp
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/ADT/APInt.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Casting.h"
+
+#include "properties.hpp"
+
+
+/// The constants a value (or a memory slot) may hold. `top` if there are too many or unknown ones.
+struct ValueSet {
+    std::vector<long long> values;  ///< Sorted, empty if nothing is known to be assigned (yet).
+    bool top;
+
+    bool join(const ValueSet& other);
+};
+
+
+/**
+ Sparse constant propagation over the sent values of a function. The constants stored into the
+ local variables (allocas) of the function are followed through casts, loads, PHIs, selects,
+ constant GEPs and memcpys, so that every send of the function can be given the set of values
+ it may transmit. The analysis is flow-insensitive: a slot holds everything ever written to it.
+
+ A slot is an alloca and a range of bytes in it, as wide as the value stored there. Accesses that
+ only partly overlap a slot (a narrower or wider load, a memcpy cutting through it) cannot tell
+ its value, they yield `top`. Allocas whose address escapes (it is stored, passed to a call other
+ than a send, or indexed dynamically) may be written by anyone, reading them yields `top`. Every value and slot can only grow until `top`, so the work is bounded by
+ the size of the function, independent of the number of sends.
+ */
+class SentValueFlow {
+public:
+    explicit SentValueFlow(llvm::Function& fn);
+
+    ValueSet valuesOf(const llvm::Value* message) const;
+
+private:
+    /// The values written to the bytes `offset..offset + width` of an alloca.
+    struct Slot {
+        int64_t width;
+        ValueSet values;
+    };
+
+    struct Slots {
+        std::map<int64_t, Slot> offsets;    ///< The slots by their offset, they do not overlap.
+        bool top;
+    };
+
+    const llvm::DataLayout& layout;
+    std::unordered_map<const llvm::AllocaInst*, Slots> allocas;
+    std::unordered_map<const llvm::AllocaInst*, std::vector<const llvm::Instruction*>> readers;
+    std::unordered_map<const llvm::Value*, ValueSet> scalars;
+    std::vector<const llvm::Instruction*> worklist;
+
+    const llvm::AllocaInst* getSlot(const llvm::Value* ptr, int64_t& offset) const;
+    ValueSet scalarOf(const llvm::Value* value) const;
+    ValueSet read(const llvm::Value* ptr, int64_t width) const;
+    void write(const llvm::AllocaInst* alloca, int64_t offset, int64_t width, const ValueSet& values);
+    void clobber(const llvm::AllocaInst* alloca);
+    void update(const llvm::Instruction* inst, const ValueSet& values);
+    void evaluate(const llvm::Instruction* inst);
+};
+
+#endif /* dataflow_hpp */
@@ -0,0 +1,171 @@
+#include "discovery.hpp"
+
+using namespace llvm;
+namespace fs = ::boost::filesystem;
+
+
+struct Artifact {
+    std::string path;
+    std::time_t mtime;
+};
+
+
+static bool isIRFile(const fs::path& path) {
+    return path.extension() == ".ll" || path.extension() == ".bc";
+}
+
+
+/**
+ Collect all IR files below a directory. The tree is traversed level by level, the directories
+ of one level are listed in parallel.
+
+ @param root The directory to start at.
+ @param thread_no The number of worker threads to use.
+ @return All IR files found, including their modification time.
+ */
+static std::vector<Artifact> collectArtifacts(const fs::path& root, int thread_no) {
+    std::vector<Artifact> artifacts {};
+    std::vector<fs::path> level {root};
+    std::mutex result_mutex;
+
+    while (!level.empty()) {
+        std::vector<fs::path> next_level {};
+
+        parallelFor(thread_no, level.size(), [&](unsigned, std::size_t idx) {
+            std::vector<Artifact> files {};
+            std::vector<fs::path> dirs {};
+            boost::system::error_code ec;
+
+            for (fs::directory_iterator it(level[idx], ec), endit; !ec && it != endit; it.increment(ec)) {
+                // symlinked directories are not followed, just like in a recursive_directory_iterator
+                fs::file_status status = it->symlink_status(ec);
+                if (ec)
+                    continue;
+                if (fs::is_directory(status))
+                    dirs.push_back(it->path());
+                else if (fs::is_regular_file(it->status(ec)) && isIRFile(it->path()))
+                    files.push_back(Artifact {it->path().string(), fs::last_write_time(it->path(), ec)});
+            }
+
+            std::lock_guard<std::mutex> lock(result_mutex);
+            artifacts.insert(artifacts.end(), files.begin(), files.end());
+            next_level.insert(next_level.end(), dirs.begin(), dirs.end());
+        });
+
+        level.swap(next_level);
+    }
+
+    // the listing order depends on the thread timing, make the result deterministic
+    std::sort(artifacts.begin(), artifacts.end(), [](const Artifact& a, const Artifact& b) { return a.path < b.path; });
+    return artifacts;
+}
+
+
+/**
+ Split the file name of a cargo build artifact into the crate name and the hash identifying the
+ build generation. Cargo names the IR files `<crate>-<16 hex digits>` (optionally followed by
+ codegen-unit suffixes like `.<crate>0-cgu.0.rcgu`).
+
+ @param path The path of the IR file.
+ @param crate Receives the crate name.
+ @param generation Receives the generation hash.
+ @return `false`, if the file does not follow cargo's naming scheme.
+ */
+static bool splitArtifactName(const std::string& path, StringRef& crate, StringRef& generation) {
+    StringRef filename = StringRef(path).rsplit('/').second;
+    if (filename.empty())
+        filename = StringRef(path);
+
+    StringRef stem = filename.split('.').first;
+    std::pair<StringRef, StringRef> parts = stem.rsplit('-');
+    if (parts.second.size() != 16 || parts.first.empty() || parts.second == stem)
+        return false;
+
+    for (char c: parts.second)
+        if (!std::isxdigit(static_cast<unsigned char>(c)))
+            return false;
+
+    crate = parts.first;
+    generation = parts.second;
+    return true;
+}
+
+
+/**
+ Find all IR files below a directory.
+
+ Cargo keeps the artifacts of earlier builds around, so a `deps` folder often contains several
+ generations of the same crate (`foo-1a2b3c....ll`, `foo-9f8e7d....ll`). With `latest_only` set,
+ only the newest generation of each crate is kept per directory (i.e. per profile and target).
+ Files not following cargo's naming scheme are always kept.
+
+ @param root The directory to scan.
+ @param thread_no The number of threads used for the traversal.
+ @param latest_only Drop stale generations of cargo artifacts.
+ @param verbose Print every file found.
+ @return The list of IR files to analyze.
+ */
+std::forward_list<std::string> scan_directory(const fs::path& root, int thread_no, bool latest_only, bool verbose) {
+    std::forward_list<std::string> files = {};
+
+    if(!fs::exists(root) || !fs::is_directory(root)) {
+        std::cerr << "[ERROR] Path is not a directory but directory traversal was issued." << std::endl;
+        return files;
+    }
+
+    std::vector<Artifact> artifacts = collectArtifacts(root, thread_no);
+    std::vector<char> keep(artifacts.size(), 1);
+
+    if (latest_only) {
+        // (directory, crate) -> generation -> newest modification time of the generation's files
+        std::map<std::pair<std::string, std::string>, std::map<std::string, std::time_t>> generations {};
+        for (const Artifact& artifact: artifacts) {
+            StringRef crate, generation;
+            if (!splitArtifactName(artifact.path, crate, generation))
+                continue;
+
+            std::string dir = fs::path(artifact.path).parent_path().string();
+            std::time_t& newest = generations[std::make_pair(dir, crate.str())][generation.str()];
+            newest = std::max(newest, artifact.mtime);
+        }
+
+        // choose the newest generation per crate, ties are broken by the hash for determinism
+        std::map<std::pair<std::string, std::string>, std::string> latest {};
+        for (const auto& crate: generations) {
+            auto best = crate.second.begin();
+            for (auto gen = crate.second.begin(); gen != crate.second.end(); ++gen)
+                if (gen->second >= best->second)
+                    best = gen;
+            latest[crate.first] = best->first;
+        }
+
+        unsigned skipped = 0;
+        for (std::size_t idx = 0; idx < artifacts.size(); ++idx) {
+            StringRef crate, generation;
+            if (!splitArtifactName(artifacts[idx].path, crate, generation))
+                continue;
+
+            std::string dir = fs::path(artifacts[idx].path).parent_path().string();
+            if (latest[std::make_pair(dir, crate.str())] != generation) {
+                keep[idx] = 0;
+                ++skipped;
+                std::cout << "Skipped stale artifact: " << artifacts[idx].path << std::endl;
+            }
+        }
+
+        if (skipped > 0)
+            std::cout << "[INFO] Skipped " << skipped << " stale build artifacts." << std::endl;
+    }
+
+    if (verbose)
+        for (std::size_t idx = 0; idx < artifacts.size(); ++idx)
+            if (keep[idx])
+                std::cout << "Loaded: " << artifacts[idx].path << std::endl;
+
+    // iterate backwards to keep the sorted order in the forward list
+    for (std::size_t idx = artifacts.size(); idx-- > 0;)
+        if (keep[idx])
+            files.push_front(artifacts[idx].path);
+
+    return files;
+}
@@ -0,0 +1,26 @@
+#ifndef discovery_hpp
+#define discovery_hpp
+
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <forward_list>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Boost Filesystem interaction
+#define BOOST_FILESYSTEM_VERSION 3
+#define BOOST_FILESYSTEM_NO_DEPRECATED
+#include <boost/filesystem.hpp>
+
+#include "llvm/ADT/StringRef.h"
+
+#include "parallel.hpp"
+
+// function definitions
+std::forward_list<std::string> scan_directory(const boost::filesystem::path& root, int thread_no, bool latest_only, bool verbose);
+
+#endif /* discovery_hpp */
@@ -0,0 +1,58 @@
+#include "interner.hpp"
+
+using namespace llvm;
+
+// The table only ever grows: the strings are owned by the map entries, which never move, so
+// the references handed out stay valid until the process exits.
+static std::mutex table_mutex;
+static StringMap<StringId> string_ids;
+static std::vector<StringRef> strings;
+
+
+/**
+ Store a string in the process-wide string table. Equal strings get the same ID, so interned
+ strings can be compared and hashed by their ID.
+
+ @param str The string to intern.
+ @return The ID of the string.
+ */
+StringId intern(StringRef str) {
+    std::lock_guard<std::mutex> lock(table_mutex);
+
+    auto inserted = string_ids.insert(std::make_pair(str, static_cast<StringId>(strings.size())));
+    if (inserted.second)
+        strings.push_back(inserted.first->getKey());
+
+    return inserted.first->getValue();
+}
+
+
+/**
+ Look up the ID of a string without adding it to the table.
+
+ @param str The string to look up.
+ @param id Receives the ID of the string.
+ @return `false`, if the string has never been interned.
+ */
+bool findInterned(StringRef str, StringId& id) {
+    std::lock_guard<std::mutex> lock(table_mutex);
+
+    auto entry = string_ids.find(str);
+    if (entry == string_ids.end())
+        return false;
+
+    id = entry->getValue();
+    return true;
+}
+
+
+/**
+ Get the string behind an ID returned by `intern`.
+
+ @param id The ID of the string.
+ @return The string, valid for the lifetime of the process.
+ */
+StringRef internedString(StringId id) {
+    std::lock_guard<std::mutex> lock(table_mutex);
+    return strings[id];
+}
@@ -0,0 +1,17 @@
+#ifndef interner_hpp
+#define interner_hpp
+
+#include <mutex>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+/// Index of a string in the process-wide string table.
+typedef unsigned StringId;
+
+StringId intern(llvm::StringRef str);
+bool findInterned(llvm::StringRef str, StringId& id);
+llvm::StringRef internedString(StringId id);
+
+#endif /* interner_hpp */
@@ -0,0 +1,95 @@
+#include "loader.hpp"
+
+using namespace llvm;
+
+
+/**
+ Parse a single IR file. Bitcode files (`.bc`) are loaded lazily: only the module-level symbols
+ are read, function bodies are materialized on demand (see `ensureMaterialized`). Textual IR is
+ parsed completely.
+
+ @param path The path of the IR file.
+ @param err Receives the diagnostic if the file cannot be parsed.
+ @param context The context that will own the module.
+ @return The module, or a `nullptr` on failure.
+ */
+std::unique_ptr<Module> parse_module(const std::string& path, SMDiagnostic& err, LLVMContext& context) {
+    if (StringRef(path).endswith(".bc"))
+        return getLazyIRFileModule(StringRef(path), err, context);
+    else
+        return parseIRFile(StringRef(path), err, context);
+}
+
+
+void report_load_error(const std::string& path, const SMDiagnostic& err) {
+    // skip malformed IR Files, emit a note about that.
+    std::cerr << "[ERROR] Couldn't read the IR file `" << path << "`. Skipping..." << std::endl;
+    err.print("IR File Loader", errs());
+}
+
+
+/**
+ Parse all IR files provided. The files are distributed over `thread_no` workers, each of which
+ owns a separate `LLVMContext` (contexts are not thread-safe). The contexts are handed back to the
+ caller through `contexts` and have to outlive the returned modules.
+
+ Malformed files are reported and skipped. The order of the returned list does not depend on
+ the number of threads used.
+
+ @param files The paths of the IR files to load.
+ @param thread_no The number of worker threads to use.
+ @param contexts Receives the contexts that own the loaded modules.
+ @return The list of successfully loaded modules.
+ */
+std::forward_list<std::unique_ptr<Module>> load_modules(const std::forward_list<std::string>& files, int thread_no, std::forward_list<std::unique_ptr<LLVMContext>>& contexts) {
+    std::vector<std::string> paths(files.begin(), files.end());
+    std::vector<std::unique_ptr<Module>> loaded(paths.size());
+
+    // one context per worker
+    unsigned workers = std::max(1u, static_cast<unsigned>(std::min<std::size_t>(thread_no, paths.size())));
+    std::vector<LLVMContext*> worker_contexts {};
+    for (unsigned w = 0; w < workers; ++w) {
+        contexts.push_front(std::unique_ptr<LLVMContext>(new LLVMContext()));
+        worker_contexts.push_back(contexts.front().get());
+    }
+
+    // keeps the error reports of different workers from interleaving
+    std::mutex report_mutex;
+
+    parallelFor(workers, paths.size(), [&](unsigned worker, std::size_t idx) {
+        SMDiagnostic err = SMDiagnostic();
+        loaded[idx] = parse_module(paths[idx], err, *worker_contexts[worker]);
+        if (!loaded[idx]) {
+            std::lock_guard<std::mutex> lock(report_mutex);
+            report_load_error(paths[idx], err);
+        }
+    });
+
+    // keep the order of the sequential loader
+    std::forward_list<std::unique_ptr<Module>> module_list {};
+    for (std::unique_ptr<Module>& mod: loaded)
+        if (mod)
+            module_list.push_front(std::move(mod));
+
+    return module_list;
+}
+
+
+/**
+ Make sure the body of a lazily loaded function is available. Functions of completely parsed
+ modules are left untouched.
+
+ @param fn The function whose body is needed.
+ @return `false`, if the body could not be read from the bitcode file.
+ */
+bool ensureMaterialized(Function* fn) {
+    if (!fn->isMaterializable())
+        return true;
+
+    if (Error e = fn->materialize()) {
+        logAllUnhandledErrors(std::move(e), errs(), "[ERROR] Couldn't materialize `" + fn->getName() + "`: ");
+        return false;
+    }
+
+    return true;
+}
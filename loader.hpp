@@ -0,0 +1,28 @@
+#ifndef loader_hpp
+#define loader_hpp
+
+#include <forward_list>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/Error.h"
+
+#include "parallel.hpp"
+
+// function definitions
+std::unique_ptr<llvm::Module> parse_module(const std::string& path, llvm::SMDiagnostic& err, llvm::LLVMContext& context);
+void report_load_error(const std::string& path, const llvm::SMDiagnostic& err);
+std::forward_list<std::unique_ptr<llvm::Module>> load_modules(const std::forward_list<std::string>& files, int thread_no, std::forward_list<std::unique_ptr<llvm::LLVMContext>>& contexts);
+bool ensureMaterialized(llvm::Function* fn);
+
+#endif /* loader_hpp */
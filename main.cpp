@@ -5,37 +5,345 @@ namespace fs = ::boost::filesystem;
 
 
 cl::OptionCategory AnalyzerCategory("Runtime Options", "Options for manipulating the runtime options of the program.");
-cl::opt<std::string> IRPath(cl::Positional, cl::desc("<IR file or directory>"), cl::Required);
-cl::opt<int> ThreadCount("t", cl::desc("Number of threads to use for calculation (currently not working)"), cl::cat(AnalyzerCategory));
+cl::opt<std::string> IRPath(cl::Positional, cl::desc("<IR/bitcode file or directory>"), cl::Required);
+cl::opt<int> ThreadCount("t", cl::desc("Number of threads to use for finding, loading and analyzing the IR files"), cl::cat(AnalyzerCategory));
 cl::opt<bool> VerboseOutput("v", cl::desc("Turn on verbose mode"), cl::cat(AnalyzerCategory));
 cl::opt<std::string> OutputPath("o", cl::desc("Optionally specify an output path for the graph"), cl::cat(AnalyzerCategory), cl::init("message_graph.dot"));
 cl::opt<bool> SuppressParentheses("s", cl::desc("Suppress empty parentheses type from graph output."), cl::cat(AnalyzerCategory));
 cl::opt<bool> GuidedAnalysis("g", cl::desc("Run a guided analysis on the graph."), cl::cat(AnalyzerCategory));
+cl::list<std::string> GuidedEntries("guided-entry", cl::desc("Run the guided analysis without interaction from a send (<namespace>:<line>) or a sending function (<namespace>:<function>), may be repeated"), cl::cat(AnalyzerCategory));
+cl::opt<std::string> GuidedEntryFile("guided-entry-file", cl::desc("Run the guided analysis without interaction from the entry points in a file, one per line"), cl::cat(AnalyzerCategory));
+cl::opt<bool> GuidedAll("guided-all", cl::desc("Run the guided analysis without interaction from every sending function"), cl::cat(AnalyzerCategory));
+cl::opt<bool> GuidedMerge("guided-merge", cl::desc("Write one graph for all entry points of a non-interactive guided analysis instead of one per entry point"), cl::cat(AnalyzerCategory));
+cl::opt<bool> Reachability("reachability", cl::desc("Index the reachability of the message graph and write the sends every send can cause next to the graph (<graph>.reach)"), cl::cat(AnalyzerCategory));
+cl::list<std::string> ReachQueries("reach-query", cl::desc("Query the reachability index: the sends downstream and the senders upstream of <namespace>:<line>, or whether <namespace>:<line>-><namespace>:<line> is reachable; may be repeated"), cl::cat(AnalyzerCategory));
 cl::opt<bool> IgnoreInitialVal("i", cl::desc("Ignore the initially sent value during guided analysis."), cl::cat(AnalyzerCategory));
 cl::opt<bool> ChooseFunction("f", cl::desc("Start the guided analysis from a function."), cl::cat(AnalyzerCategory));
+cl::opt<std::string> CachePath("cache", cl::desc("Directory for caching the analysis results of unchanged IR files"), cl::cat(AnalyzerCategory));
+cl::opt<bool> StreamModules("stream", cl::desc("Analyze one module at a time and release it before loading the next one"), cl::cat(AnalyzerCategory));
+cl::opt<bool> AllArtifacts("all-artifacts", cl::desc("Analyze every IR file in the directory, including stale cargo build artifacts"), cl::cat(AnalyzerCategory));
+cl::opt<bool> ScanAllInstructions("scan-all-instructions", cl::desc("Find sends/recvs by visiting every instruction instead of the call sites of channel functions"), cl::cat(AnalyzerCategory));
+cl::opt<std::string> ChannelConfig("channels", cl::desc("Load additional channel APIs (send/recv functions) from a configuration file"), cl::cat(AnalyzerCategory));
+cl::opt<bool> TrackChannels("track-channels", cl::desc("Match sends and recvs by the channel they use (found through the channel creation sites), fall back to their type if it is unknown"), cl::cat(AnalyzerCategory));
+cl::opt<SenderAnalysis> SenderMode("sender-analysis", cl::desc("How to find the values of the sent messages"), cl::cat(AnalyzerCategory), cl::init(WalkSenderAnalysis),
+    cl::values(clEnumValN(WalkSenderAnalysis, "walk", "Search the store of a constant from every send (default)"),
+               clEnumValN(DataflowSenderAnalysis, "dataflow", "Propagate the constants through every function once, finds every value a message may have"),
+               clEnumValN(MemorySSASenderAnalysis, "memoryssa", "Find the stores reaching every send with MemorySSA and alias analysis, for optimized IR")));
+cl::opt<unsigned> MaxSteps("max-steps", cl::desc("Number of values/blocks the analysis of a single send/recv or guided traversal may visit (0: unlimited)"), cl::cat(AnalyzerCategory), cl::init(1000000));
+cl::opt<unsigned> MaxDepth("max-depth", cl::desc("Search depth the analysis of a single send/recv or guided traversal may reach (0: unlimited)"), cl::cat(AnalyzerCategory), cl::init(10000));
+cl::opt<unsigned> MaxTime("max-time", cl::desc("Milliseconds the analysis of a single send/recv or guided traversal may take (0: unlimited)"), cl::cat(AnalyzerCategory), cl::init(0));
+cl::opt<bool> FullParse("full-parse", cl::desc("Parse every input file, even if the pre-filter finds no channel symbols in it."), cl::cat(AnalyzerCategory));
 
 
-std::forward_list<std::string> scan_directory(const fs::path& root) {
-    std::forward_list<std::string> files = {};
+/**
+ Run the sender and receiver analyses on all nodes that are still attached to their instruction.
+ Both analyses only read the IR, so the nodes are analyzed on up to `thread_no` threads. The
+ messages of every node are buffered and printed in node order (sends first) afterwards, the
+ output is the same for any number of threads.
 
-    if(!fs::exists(root) || !fs::is_directory(root)) {
-        std::cerr << "[ERROR] Path is not a directory but directory traversal was issued." << std::endl;
-        return files;
+ The sends of a function share the values searched by the sender analysis (which rarely leaves
+ the function), its dataflow analysis or MemorySSA, so they are analyzed one after another by the same thread.
+ With MemorySSA, all sends of an LLVMContext are analyzed by the same thread, building and
+ querying its alias analysis is not thread-safe within a context.
+
+ Every node is analyzed within its own budget. A node whose analysis runs out of it is marked
+ inconclusive and the remaining nodes go on.
+
+ @param store The nodes, send nodes receive the sent values and recv nodes the usage of the received values.
+ @param thread_no The number of threads to use.
+ @param sender_analysis The analysis finding the sent values.
+ @param budget The budget of every node.
+ @param records Receives the work spent on every analyzed node, in node order.
+ */
+void analyze_nodes(NodeStore& store, int thread_no, SenderAnalysis sender_analysis, const AnalysisBudget& budget, std::vector<BudgetRecord>& records) {
+    std::vector<NodeId> nodes(store.sends());
+    std::size_t send_count = nodes.size();
+    nodes.insert(nodes.end(), store.recvs().begin(), store.recvs().end());
+
+    // every recv is a group of its own
+    std::vector<std::vector<std::size_t>> groups {};
+    std::unordered_map<const Function*, std::size_t> send_groups {};
+    for (std::size_t idx = 0; idx < nodes.size(); ++idx) {
+        Instruction* instr = store[nodes[idx]].instr;
+        if (idx < send_count && instr) {
+            auto group = send_groups.insert(std::make_pair(instr->getFunction(), groups.size()));
+            if (group.second)
+                groups.push_back(std::vector<std::size_t>());
+            groups[group.first->second].push_back(idx);
+        }
+        else
+            groups.push_back(std::vector<std::size_t>(1, idx));
     }
 
-    fs::recursive_directory_iterator it(root);
-    fs::recursive_directory_iterator endit;
+    std::vector<std::string> messages(nodes.size());
+    std::vector<BudgetRecord> node_records(nodes.size());
+    std::vector<char> analyzed(nodes.size(), 0);
+    // the values are copied into the store afterwards, its arena is not thread-safe
+    std::vector<std::vector<long long>> sent_values(send_count);
+    auto analyze_node = [&](std::size_t idx, SenderState& state) {
+        MessagingNode& node = store[nodes[idx]];
+        // for further analysis, ignore nodes of type "()" and cached nodes (already analyzed)
+        if (!node.instr || internedString(node.type) == "()")
+            return;
+
+        raw_string_ostream log(messages[idx]);
+        BudgetMeter meter(budget);
+        if (idx < send_count) {
+            // perform the sender analysis
+            std::vector<long long>& values = sent_values[idx];
+            // all sends of the group are in the same function
+            if (sender_analysis == DataflowSenderAnalysis) {
+                if (!state.flow)
+                    state.flow.reset(new SentValueFlow(*node.instr->getFunction()));
+                values = analyzeSenderDataflow(node.instr, *state.flow, log);
+            }
+            else if (sender_analysis == MemorySSASenderAnalysis) {
+                if (!state.resolver)
+                    state.resolver.reset(new StoreResolver(*node.instr->getFunction()));
+                values = analyzeSenderMemorySSA(node.instr, *state.resolver, meter, log);
+            }
+            else {
+                long long sent_val = analyzeSender(node.instr, state.cache, meter, log);
+                if (sent_val != -1)
+                    values.push_back(sent_val);
+            }
 
-    while(it != endit) {
-        if(fs::is_regular_file(*it) && it->path().extension() == ".ll") {
-            if (VerboseOutput)
-                std::cout << "Loaded: " << it->path().string() << std::endl;
-            files.push_front(it->path().string());
+            if (!values.empty()) {
+                log << "[Got!] Found assignment of " << values.front();
+                for (std::size_t value = 1; value < values.size(); ++value)
+                    log << ", " << values[value];
+                log << "\n";
+            } else if (meter.exhausted()) {
+                log << "[Inconclusive!] Ran out of budget searching the assignment. Type: " << internedString(node.type) << "\n";
+            } else {
+                log << "[Miss!] Could not find assignment. Type: " << internedString(node.type) << "\n";
+            }
+        }
+        else {
+            // perform the receiver-side analysis
+            node.usage = analyzeReceiver(node.instr, meter, log);
         }
-        ++it;
+        node.inconclusive = meter.exhausted();
+
+        std::string subject = std::string(idx < send_count ? "send " : "recv ") + internedString(node.type).str() + " at " \
+            + internedString(node.nspace).str() + ":" + std::to_string(node.line) + " (" + node.function.str() + ")";
+        node_records[idx] = makeBudgetRecord(std::move(subject), meter);
+        analyzed[idx] = 1;
+    };
+
+    // the alias analysis of MemorySSA registers value handles (of its assumption cache) in the
+    // LLVMContext, which has no lock, so the send groups of a context are analyzed by one thread
+    std::vector<std::vector<std::size_t>> tasks {};
+    std::unordered_map<const LLVMContext*, std::size_t> context_tasks {};
+    for (std::size_t group = 0; group < groups.size(); ++group) {
+        Instruction* instr = store[nodes[groups[group].front()]].instr;
+        if (sender_analysis == MemorySSASenderAnalysis && groups[group].front() < send_count && instr) {
+            auto task = context_tasks.insert(std::make_pair(&instr->getContext(), tasks.size()));
+            if (task.second)
+                tasks.push_back(std::vector<std::size_t>());
+            tasks[task.first->second].push_back(group);
+        }
+        else
+            tasks.push_back(std::vector<std::size_t>(1, group));
+    }
+
+    parallelFor(thread_no, tasks.size(), [&](unsigned, std::size_t task) {
+        for (std::size_t group: tasks[task]) {
+            SenderState state {};
+            for (std::size_t idx: groups[group])
+                analyze_node(idx, state);
+        }
+    });
+
+    for (std::size_t idx = 0; idx < send_count; ++idx)
+        if (analyzed[idx])
+            store.setAssignments(nodes[idx], sent_values[idx]);
+
+    for (const std::string& message: messages)
+        outs() << message;
+    for (std::size_t idx = 0; idx < nodes.size(); ++idx)
+        if (analyzed[idx])
+            records.push_back(std::move(node_records[idx]));
+}
+
+
+/**
+ Read the entry points of a non-interactive guided analysis. Empty lines and lines starting with
+ `#` are skipped.
+
+ @param path The file, one entry point per line.
+ @param entries Receives the entry points.
+ @return `false`, if the file could not be read.
+ */
+bool read_guided_entries(const std::string& path, std::vector<std::string>& entries) {
+    std::ifstream file(path);
+    if (!file.good()) {
+        std::cerr << "[ERROR] Could not read the entry points from " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        StringRef entry = StringRef(line).trim();
+        if (!entry.empty() && !entry.startswith("#"))
+            entries.push_back(entry.str());
+    }
+    return true;
+}
+
+
+/**
+ Write the graphs of a non-interactive guided analysis: either one graph of all entry points, or
+ one per entry point, numbered in their order (`message_graph.1.dot`, ...).
+
+ @param store The nodes.
+ @param results The pairs explored from every entry point.
+ @param merge Write a single graph.
+ @param output_path The path of the graph, the numbers are inserted before its `.dot` extension.
+ */
+void write_guided_graphs(const NodeStore& store, const std::vector<GuidedResult>& results, bool merge, const std::string& output_path) {
+    if (merge) {
+        std::vector<NodePair> merged {};
+        std::set<NodePair> seen {};
+        for (const GuidedResult& result: results)
+            for (NodePair pair: result.pairs)
+                if (seen.insert(pair).second)
+                    merged.push_back(pair);
+        visualize(store, &merged, output_path);
+        return;
     }
 
-    return files;
+    StringRef stem = output_path;
+    if (stem.endswith(".dot"))
+        stem = stem.drop_back(4);
+    for (std::size_t idx = 0; idx < results.size(); ++idx) {
+        if (results[idx].pairs.empty())
+            continue;
+
+        std::string path = stem.str() + "." + std::to_string(idx + 1) + ".dot";
+        std::cout << "[INFO] Entry point " << results[idx].entry << ": " << results[idx].pairs.size() << " pairs, written to " << path << std::endl;
+        visualize(store, &results[idx].pairs, path);
+    }
+}
+
+
+// the nodes at `<namespace>:<line>`
+static std::vector<NodeId> find_nodes(const NodeStore& store, const std::string& spec) {
+    std::vector<NodeId> nodes {};
+    std::size_t split = spec.rfind(':');
+    StringId nspace;
+    if (split == std::string::npos || !findInterned(spec.substr(0, split), nspace))
+        return nodes;
+
+    // a line number out of range matches no node
+    unsigned line;
+    if (StringRef(spec.substr(split + 1)).getAsInteger(10, line))
+        return nodes;
+    for (NodeId id = 0; id < store.size(); ++id)
+        if (store[id].nspace == nspace && store[id].line == line)
+            nodes.push_back(id);
+    return nodes;
+}
+
+
+static void print_nodes(const NodeStore& store, const char* title, const std::vector<NodeId>& nodes) {
+    std::cout << "  " << title << ":";
+    if (nodes.empty())
+        std::cout << " none";
+    for (NodeId id: nodes)
+        std::cout << "\n    " << internedString(store[id].nspace).str() << ":" << store[id].line << " (" << internedString(store[id].type).str() << ")";
+    std::cout << std::endl;
+}
+
+
+/**
+ Answer the reachability queries given on the command line.
+
+ @param store The nodes.
+ @param reachability The index of the nodes.
+ @param queries The queries: `<namespace>:<line>` for the sends downstream and the senders upstream
+    of the sends/recvs at a line, or `<namespace>:<line>-><namespace>:<line>` for whether any node
+    at the first line reaches any node at the second.
+ */
+void run_reach_queries(const NodeStore& store, const MessageReachability& reachability, const std::vector<std::string>& queries) {
+    for (const std::string& query: queries) {
+        std::size_t arrow = query.find("->");
+        std::vector<NodeId> from = find_nodes(store, query.substr(0, arrow));
+        std::vector<NodeId> to {};
+        if (arrow != std::string::npos)
+            to = find_nodes(store, query.substr(arrow + 2));
+        if (from.empty() || (arrow != std::string::npos && to.empty())) {
+            std::cout << "[WARN] No send or recv matches the reachability query `" << query << "`." << std::endl;
+            continue;
+        }
+
+        if (arrow != std::string::npos) {
+            bool reached = false;
+            for (NodeId source: from)
+                for (NodeId target: to)
+                    reached = reached || reachability.reaches(source, target);
+            std::cout << "[INFO] " << query << ": " << (reached ? "reachable" : "not reachable") << std::endl;
+            continue;
+        }
+
+        // the union over the nodes at the line
+        std::set<NodeId> downstream {};
+        std::set<NodeId> upstream {};
+        for (NodeId node: from) {
+            std::vector<NodeId> sends = reachability.downstreamSends(node);
+            downstream.insert(sends.begin(), sends.end());
+            std::vector<NodeId> senders = reachability.upstreamSenders(node);
+            upstream.insert(senders.begin(), senders.end());
+        }
+        std::cout << "[INFO] " << query << ":" << std::endl;
+        print_nodes(store, "downstream sends", std::vector<NodeId>(downstream.begin(), downstream.end()));
+        print_nodes(store, "upstream senders", std::vector<NodeId>(upstream.begin(), upstream.end()));
+    }
+}
+
+
+/**
+ Process the files one after another: load a module, scan and analyze it, keep only the
+ self-contained node records and release the module (and its context) again. Peak memory is
+ bounded by the largest module instead of the sum of all modules.
+
+ @param files The IR files to process.
+ @param cache_keys The cache keys of the files, results are stored in the cache if not empty.
+ @param budget The budget of every node.
+ @param records Receives the work spent on every analyzed node.
+ @param store Receives the detached nodes.
+ */
+void stream_modules(const std::forward_list<std::string>& files, const std::unordered_map<std::string, std::string>& cache_keys, const AnalysisBudget& budget, std::vector<BudgetRecord>& records, NodeStore& store) {
+    for (const std::string& path: files) {
+        // a fresh context per module, types and constants would pile up in a shared one
+        LLVMContext context;
+        SMDiagnostic err = SMDiagnostic();
+        std::forward_list<std::unique_ptr<Module>> module {};
+        module.push_front(parse_module(path, err, context));
+        if (!module.front()) {
+            report_load_error(path, err);
+            continue;
+        }
+
+        // the nodes of earlier modules are detached already, so only the new ones are analyzed
+        NodeId first_node = static_cast<NodeId>(store.size());
+        scan_module(module.front(), true, ScanAllInstructions, TrackChannels, store);
+        analyze_nodes(store, ThreadCount, SenderMode, budget, records);
+
+        if (!CachePath.empty())
+            store_cache(CachePath, module, cache_keys, store);
+
+        // detach the records from the IR before it is released
+        for (NodeId id = first_node; id < store.size(); ++id)
+            store[id].instr = nullptr;
+        // the IDs are ascending, so the recvs of this module are at the end of the list
+        const std::vector<NodeId>& recvs = store.recvs();
+        for (auto it = std::lower_bound(recvs.begin(), recvs.end(), first_node); it != recvs.end(); ++it)
+            store[*it].usage.second = nullptr;
+
+        // the function addresses may be reused by the next module
+        forgetCallees(module.front().get());
+    }
 }
 
 
@@ -50,6 +358,18 @@ int main(int argc, char** argv) {
     if (OutputPath.empty())
         OutputPath = "message_graph.dot";
 
+    // entry points given up front make the guided analysis non-interactive
+    std::vector<std::string> guided_entries(GuidedEntries.begin(), GuidedEntries.end());
+    if (!GuidedEntryFile.empty() && !read_guided_entries(GuidedEntryFile, guided_entries))
+        return 1;
+    bool batch_guided = !guided_entries.empty() || GuidedAll;
+    if (batch_guided)
+        GuidedAnalysis = true;
+
+    // the channel APIs have to be known before the first function is classified
+    if (!ChannelConfig.empty() && !loadChannelConfig(ChannelConfig))
+        return 1;
+
     std::forward_list<std::string> file_list {};
     struct stat s;
     // check if the path is valid and if it describes a file or directory
@@ -62,7 +382,7 @@ int main(int argc, char** argv) {
         else if (s.st_mode & S_IFDIR) {
             // path specifies a directory
             std::cout << "[INFO] Reading directory." << std::endl;
-            file_list = scan_directory(IRPath.c_str());
+            file_list = scan_directory(IRPath.c_str(), ThreadCount, !AllArtifacts, VerboseOutput);
         }
         else {
             std::cerr << "[ERROR] The path provided does not appear to be a directory, nor a file." << std::endl;
@@ -74,71 +394,109 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    // TODO: Do this in threads?
+    // skip files that cannot contain any send or recv before handing them to the parser
+    if (!FullParse)
+        file_list = prefilter_files(file_list, ThreadCount, VerboseOutput);
 
-    std::cout << "[INFO] Loading modules..." << std::endl;
-    SMDiagnostic err = SMDiagnostic();
-    LLVMContext context;
-    std::forward_list<std::unique_ptr<Module>> module_list {};
-
-    // TODO: Load all modules in data structure
-    //       -> separate structures for threading support?
-    for (std::string path: file_list) {
-        std::unique_ptr<Module> mod = parseIRFile(StringRef(path), err, context);
-        if (!mod) {
-            // skip malformed IR Files, emit a note about that.
-            std::cerr << "[ERROR] Couldn't read the IR file `" << path << "`. Skipping..." << std::endl;
-            err.print("IR File Loader", errs());
-        }
+    // restore the results of unchanged files from the cache, only the remaining files are parsed.
+    // The guided analysis needs the IR of every module, so the cache cannot be used then.
+    NodeStore store;
+    std::unordered_map<std::string, std::string> cache_keys {};
+    if (!CachePath.empty()) {
+        if (GuidedAnalysis)
+            std::cout << "[INFO] The analysis cache is not used during a guided analysis." << std::endl;
         else {
-            module_list.push_front(std::move(mod));
+            // the options that change the results of the analysis
+            std::string options = "sender-analysis=" + std::to_string(static_cast<int>(SenderMode)) + "\n" + (TrackChannels ? "track-channels\n" : "");
+            file_list = lookup_cache(CachePath, file_list, ThreadCount, options, cache_keys, store);
         }
     }
 
-    std::cout << "[INFO] Scanning modules for sends/recvs..." << std::endl;
+    // the IR is released while streaming, but the guided analysis needs all of it
+    if (StreamModules && GuidedAnalysis) {
+        std::cout << "[INFO] Streaming is not possible during a guided analysis, loading all modules." << std::endl;
+        StreamModules = false;
+    }
 
-    std::forward_list<MessagingNode> sends, recvs;
-    std::tie(sends, recvs) = scan_modules(module_list, ThreadCount);
+    AnalysisBudget budget {MaxSteps, MaxDepth, MaxTime};
+    std::vector<BudgetRecord> budget_records {};
 
-    // for (MessagingNode mn: sends)
-    //     outs() << "send: " << mn.type << " : " << mn.nspace << "\n  " << *mn.instr << "\n\n";
+    // the contexts have to outlive the modules, so they are declared first
+    std::forward_list<std::unique_ptr<LLVMContext>> contexts {};
+    std::forward_list<std::unique_ptr<Module>> module_list {};
 
-    // for (MessagingNode mn: recvs)
-    //     outs() << "recv: " << mn.type << " : " << mn.nspace << "\n  " << *mn.instr << "\n\n";
+    if (StreamModules) {
+        std::cout << "[INFO] Streaming modules..." << std::endl;
+        stream_modules(file_list, cache_keys, budget, budget_records, store);
+    }
+    else {
+        std::cout << "[INFO] Loading modules..." << std::endl;
+        module_list = load_modules(file_list, ThreadCount, contexts);
+
+        std::cout << "[INFO] Scanning modules for sends/recvs..." << std::endl;
+        // the guided analysis and the reachability index follow the calls into functions without sends/recvs
+        scan_modules(module_list, ThreadCount, !GuidedAnalysis && !Reachability && ReachQueries.empty(), ScanAllInstructions, TrackChannels, store);
+    }
+
+    if (TrackChannels) {
+        unsigned resolved = 0;
+        for (NodeId id = 0; id < store.size(); ++id)
+            if (store[id].channel != NoChannel)
+                ++resolved;
+        std::cout << "[INFO] Channel tracking: found the channel of " << resolved << " of " << store.size() << " sends/recvs." << std::endl;
+    }
 
-    // match senders and receivers
+    // for (NodeId id: store.sends())
+    //     outs() << "send: " << internedString(store[id].type) << " : " << internedString(store[id].nspace) << "\n  " << *store[id].instr << "\n\n";
+
+    // for (NodeId id: store.recvs())
+    //     outs() << "recv: " << internedString(store[id].type) << " : " << internedString(store[id].nspace) << "\n  " << *store[id].instr << "\n\n";
+
+    // match senders and receivers. Nodes restored from the cache take part like freshly scanned ones.
     outs() << "[INFO] Starting Analysis...\n";
-    std::forward_list<std::pair<MessagingNode*, MessagingNode*>> node_pairs = analyzeNodes(sends, recvs, SuppressParentheses);
+    std::vector<NodePair> node_pairs = analyzeNodes(store, SuppressParentheses, ThreadCount);
 
     if (VerboseOutput)
-        for (std::pair<MessagingNode*, MessagingNode*> pair: node_pairs)
-            std::cout << "[matched] " << pair.first->type << " --> " << pair.second->type << std::endl;
-
-    // perform the sender analysis
-    for (MessagingNode& send: sends) {
-        // for further analysis, ignore senders of type "()"
-        if (send.type != "()") {
-            long long sent_val = analyzeSender(send.instr);
-            if (sent_val != -1) {
-                outs() << "[Got!] Found assignment of " << sent_val << "\n";
-            } else {
-                outs() << "[Miss!] Could not find assignment. Type: " << send.type << "\n";
-            }
-            send.assignment = sent_val;
-        }
-    }
+        for (NodePair pair: node_pairs)
+            std::cout << "[matched] " << internedString(store[pair.first].type).str() << " --> " << internedString(store[pair.second].type).str() << std::endl;
 
-    // perform the receiver analysis
-    for (MessagingNode& recv: recvs) {
-        // perform the receiver-side analysis
-        if (recv.type != "()")
-            recv.usage = analyzeReceiver(recv.instr);
-    }
+    // streamed nodes have been analyzed (and cached) already
+    if (!StreamModules) {
+        analyze_nodes(store, ThreadCount, SenderMode, budget, budget_records);
 
+        if (!CachePath.empty() && !GuidedAnalysis)
+            store_cache(CachePath, module_list, cache_keys, store);
+    }
 
     if (!GuidedAnalysis)
-        visualize(&node_pairs, OutputPath);
+        visualize(store, &node_pairs, OutputPath);
+    else if (batch_guided)
+        write_guided_graphs(store, analyzeGuidedBatch(store, &node_pairs, guided_entries, GuidedAll, ThreadCount, budget, budget_records), GuidedMerge, OutputPath);
     else
-        visualize(analyzeGuided(&node_pairs, IgnoreInitialVal, ChooseFunction), OutputPath);
+        visualize(store, analyzeGuided(store, &node_pairs, IgnoreInitialVal, ChooseFunction, budget, budget_records), OutputPath);
+
+    if (Reachability || !ReachQueries.empty()) {
+        // the send-after-receive edges need the IR, recvs from the cache or streamed modules only have their pairs
+        long detached = std::count_if(store.recvs().begin(), store.recvs().end(), [&](NodeId id) { return !store[id].instr; });
+        if (detached > 0)
+            std::cout << "[WARN] " << detached << " recvs were restored from the cache or streamed, the reachability index does not know which sends follow them." << std::endl;
+
+        MessageReachability reachability(store, node_pairs);
+        std::cout << "[INFO] Reachability index: " << reachability.pairEdges() << " pair edges, " << reachability.receiveEdges() << " send-after-receive edges, " \
+            << reachability.componentCount() << " components, " << reachability.intervalCount() << " label intervals." << std::endl;
+
+        if (Reachability) {
+            StringRef stem = StringRef(OutputPath);
+            if (stem.endswith(".dot"))
+                stem = stem.drop_back(4);
+            exportReachability(store, reachability, stem.str() + ".reach");
+        }
+        run_reach_queries(store, reachability, std::vector<std::string>(ReachQueries.begin(), ReachQueries.end()));
+    }
+
+    printBudgetSummary(budget_records, budget, outs());
+
+    if (VerboseOutput)
+        std::cout << "[INFO] Callee classification cache: " << calleeCacheHits() << " hits in " << calleeCacheLookups() << " lookups." << std::endl;
     return 0;
 }
@@ -1,9 +1,15 @@
 #ifndef main_hpp
 #define main_hpp
 
+#include <algorithm>
+#include <cctype>
 #include <forward_list>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
 #include <sys/stat.h>
 
 // Boost Filesystem interaction
@@ -20,10 +26,17 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include "nodestore.hpp"
+#include "discovery.hpp"
+#include "prefilter.hpp"
+#include "cache.hpp"
+#include "loader.hpp"
 #include "scanner.hpp"
 #include "matching.hpp"
 #include "visualizer.hpp"
 #include "analysis.hpp"
 #include "analysisguide.hpp"
+#include "budget.hpp"
+#include "reachability.hpp"
 
 #endif /* main_hpp */
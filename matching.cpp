@@ -1,49 +1,92 @@
 #include "matching.hpp"
 
+using namespace llvm;
 
-// TODO: make arguments const?
-std::forward_list<std::pair<MessagingNode*, MessagingNode*>> analyzeNodes(std::forward_list<MessagingNode>& sends, std::forward_list<MessagingNode>& recvs, bool suppress_parentheses) {
-    std::forward_list<std::pair<MessagingNode*, MessagingNode*>> matched {};
 
-    for (MessagingNode& send: sends) {
-        if (suppress_parentheses) {
-            if (send.type == "()" || send.type.substr(0, 23) == "core::result::Result<()" || send.type.substr(0, 23) == "core::option::Option<()")
+/**
+ Match the senders and receivers by the type of their messages. The type names are parsed into
+ type trees, a send and a recv match if their trees match (see `RustTypeTable::matches`). Paths
+ are compared on segment boundaries, the shorter path has to be a suffix of the longer one. This
+ is due to namespacing and can be illustrated using the following example:
+        sent: weatherstation::Weather
+        recv:                 Weather
+
+ The types are the same, but the names are different due to namespacing.
+
+ If the channels of both the send and the recv are known (see `resolveChannels`), they only
+ match if they use the same channel.
+
+ Instead of comparing every send with every recv, the receivers are bucketed by their type tree
+ and the buckets are indexed by the kind, arity and last path segment of the tree. A sent type
+ only compares itself with the buckets under its own key. Every distinct sent type is looked up
+ once, on up to `thread_no` threads.
+
+ @param store The send and recv nodes.
+ @param suppress_parentheses Ignore nodes transmitting `()` (or results/options of it).
+ @param thread_no The number of threads used for the lookups.
+ @return The matched pairs, ordered by send and then by recv.
+ */
+std::vector<NodePair> analyzeNodes(const NodeStore& store, bool suppress_parentheses, int thread_no) {
+    RustTypeTable types {};
+
+    // bucket the receivers by their type tree. The node IDs within a bucket are ascending.
+    std::unordered_map<TypeId, unsigned> bucket_of {};
+    std::vector<TypeId> bucket_types {};
+    std::vector<std::vector<NodeId>> buckets {};
+    for (NodeId recv_id: store.recvs()) {
+        TypeId type = types.parse(store[recv_id].type);
+        auto bucket = bucket_of.find(type);
+        if (bucket == bucket_of.end()) {
+            if (suppress_parentheses && types.isUnitWrapper(type))
                 continue;
+
+            bucket = bucket_of.insert(std::make_pair(type, static_cast<unsigned>(buckets.size()))).first;
+            bucket_types.push_back(type);
+            buckets.push_back(std::vector<NodeId>());
         }
-        for (MessagingNode& recv: recvs) {
-            if (suppress_parentheses) {
-                if (recv.type == "()" || recv.type.substr(0, 23) == "core::result::Result<()" || recv.type.substr(0, 23) == "core::option::Option<()")
-                    continue;
-            }
-            // there are various options for matching here:
-            //      - either the types have the same length and are of the same type, or
-            //      - the two types are of different length and the program has to check whether
-            //        the last len(n) characters of the longer string match the shorter one.
-            //        This is due to namespacing and can be illustrated using the following example:
-            //              sent: weatherstation::Weather
-            //              recv:                 Weather
-            //
-            //        The types are the same, but the names are different due to namespacing.
-            long compared = send.type.length() - recv.type.length();
-            if (compared == 0) {
-                if (send.type == recv.type) {
-                    matched.push_front(std::make_pair(&send, &recv));
-                }
-            }
-            else if (compared < 0) {
-                // send is shorter than recv
-                if (recv.type.substr(recv.type.length() - send.type.length()) == send.type) {
-                    matched.push_front(std::make_pair(&send, &recv));
-                }
-            }
-            else {
-                // recv is shorter than send
-                if (send.type.substr(send.type.length() - recv.type.length()) == recv.type) {
-                    matched.push_front(std::make_pair(&send, &recv));
-                }
-            }
-        }
+        buckets[bucket->second].push_back(recv_id);
     }
 
+    // only trees with the same index key can match
+    std::unordered_map<std::uint64_t, std::vector<unsigned>> index {};
+    for (unsigned idx = 0; idx < bucket_types.size(); ++idx)
+        index[types.indexKey(bucket_types[idx])].push_back(idx);
+
+    // collect the distinct sent types. The table is not thread-safe, so they are parsed up front.
+    std::unordered_map<StringId, unsigned> send_type_idx {};
+    std::vector<TypeId> send_types {};
+    for (NodeId send_id: store.sends())
+        if (send_type_idx.insert(std::make_pair(store[send_id].type, static_cast<unsigned>(send_types.size()))).second)
+            send_types.push_back(types.parse(store[send_id].type));
+
+    // look up the matching receivers of every sent type
+    std::vector<std::vector<NodeId>> candidates(send_types.size());
+    parallelFor(thread_no, send_types.size(), [&](unsigned, std::size_t idx) {
+        TypeId type = send_types[idx];
+        if (suppress_parentheses && types.isUnitWrapper(type))
+            return;
+
+        auto same_key = index.find(types.indexKey(type));
+        if (same_key == index.end())
+            return;
+
+        // the buckets are disjoint, sorting the node IDs restores the order of the receivers
+        std::vector<NodeId>& recvs = candidates[idx];
+        for (unsigned bucket: same_key->second)
+            if (types.matches(type, bucket_types[bucket]))
+                recvs.insert(recvs.end(), buckets[bucket].begin(), buckets[bucket].end());
+        std::sort(recvs.begin(), recvs.end());
+    });
+
+    std::vector<NodePair> matched {};
+    for (NodeId send_id: store.sends())
+        for (NodeId recv_id: candidates[send_type_idx[store[send_id].type]]) {
+            StringId send_channel = store[send_id].channel;
+            StringId recv_channel = store[recv_id].channel;
+            if (send_channel != NoChannel && recv_channel != NoChannel && send_channel != recv_channel)
+                continue;
+            matched.push_back(std::make_pair(send_id, recv_id));
+        }
+
     return matched;
 }
@@ -1,12 +1,18 @@
 #ifndef analyzer_hpp
 #define analyzer_hpp
 
-#include <forward_list>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 #include <iostream>
 
 #include "types.hpp"
+#include "nodestore.hpp"
+#include "rusttype.hpp"
+#include "parallel.hpp"
 
 // function definitions
-std::forward_list<std::pair<MessagingNode*, MessagingNode*>> analyzeNodes(std::forward_list<MessagingNode>& sends, std::forward_list<MessagingNode>& recvs, bool suppress_parentheses);
+std::vector<NodePair> analyzeNodes(const NodeStore& store, bool suppress_parentheses, int thread_no);
 
 #endif /* analyzer_hpp */
@@ -0,0 +1,49 @@
+#include "nodestore.hpp"
+
+using namespace llvm;
+
+
+/**
+ Add a send node to the store. The function name is copied into the store's arena.
+
+ @return The ID of the new node.
+ */
+NodeId NodeStore::addSend(Instruction* instr, StringId type, StringId nspace, unsigned line, StringRef function, long long assignment) {
+    NodeId id = static_cast<NodeId>(nodes.size());
+    nodes.push_back(MessagingNode {instr, type, nspace, line, strings.save(function), NoChannel, false, {}, .assignment = -1});
+    send_ids.push_back(id);
+    if (assignment != -1)
+        setAssignments(id, assignment);
+    return id;
+}
+
+
+/**
+ Add a recv node to the store. The function name is copied into the store's arena.
+
+ @return The ID of the new node.
+ */
+NodeId NodeStore::addRecv(Instruction* instr, StringId type, StringId nspace, unsigned line, StringRef function, UsageType usage) {
+    NodeId id = static_cast<NodeId>(nodes.size());
+    nodes.push_back(MessagingNode {instr, type, nspace, line, strings.save(function), NoChannel, false, {}, .usage = std::make_pair(usage, (Instruction*) nullptr)});
+    recv_ids.push_back(id);
+    return id;
+}
+
+
+/**
+ Set the values a send may transmit. The values are copied into the store's arena, `assignment`
+ is set to the value if there is exactly one.
+ */
+void NodeStore::setAssignments(NodeId id, ArrayRef<long long> values) {
+    MessagingNode& node = nodes[id];
+    node.assignment = values.size() == 1 ? values.front() : -1;
+    if (values.empty()) {
+        node.assignments = ArrayRef<long long>();
+        return;
+    }
+
+    long long* copy = allocator.Allocate<long long>(values.size());
+    std::copy(values.begin(), values.end(), copy);
+    node.assignments = ArrayRef<long long>(copy, values.size());
+}
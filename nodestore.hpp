@@ -0,0 +1,58 @@
+#ifndef nodestore_hpp
+#define nodestore_hpp
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
+
+#include "types.hpp"
+
+/// Marks the absence of a node, e.g. a guided analysis without an entry point.
+const NodeId NoNode = std::numeric_limits<NodeId>::max();
+
+/// Marks a node whose channel is not known, such nodes are matched by their type only.
+const StringId NoChannel = std::numeric_limits<StringId>::max();
+
+
+/**
+ Holds all send and recv nodes of a run in one contiguous table. Nodes are addressed by their
+ index, which stays valid for the lifetime of the store. Types and namespaces are interned, the
+ function names are kept in an arena owned by the store, so adding a node allocates no
+ individual strings.
+ */
+class NodeStore {
+public:
+    NodeStore() : strings(allocator) {}
+    NodeStore(const NodeStore&) = delete;
+    NodeStore& operator=(const NodeStore&) = delete;
+
+    NodeId addSend(llvm::Instruction* instr, StringId type, StringId nspace, unsigned line, llvm::StringRef function, long long assignment);
+    NodeId addRecv(llvm::Instruction* instr, StringId type, StringId nspace, unsigned line, llvm::StringRef function, UsageType usage);
+    void setAssignments(NodeId id, llvm::ArrayRef<long long> values);
+
+    MessagingNode& operator[](NodeId id) { return nodes[id]; }
+    const MessagingNode& operator[](NodeId id) const { return nodes[id]; }
+
+    /// The IDs of all send nodes, in the order they were added.
+    const std::vector<NodeId>& sends() const { return send_ids; }
+    /// The IDs of all recv nodes, in the order they were added.
+    const std::vector<NodeId>& recvs() const { return recv_ids; }
+    /// The number of nodes, which is also the ID the next node will get.
+    std::size_t size() const { return nodes.size(); }
+
+private:
+    std::vector<MessagingNode> nodes;
+    std::vector<NodeId> send_ids;
+    std::vector<NodeId> recv_ids;
+
+    llvm::BumpPtrAllocator allocator;
+    llvm::StringSaver strings;
+};
+
+#endif /* nodestore_hpp */
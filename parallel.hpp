@@ -0,0 +1,42 @@
+#ifndef parallel_hpp
+#define parallel_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+/**
+ Run `fn(worker, index)` for every index in [0, count) using up to `thread_no` worker threads.
+ Workers pick the next unprocessed index from a shared counter, so long-running items do not
+ hold up the remaining work. With a single worker, everything runs on the calling thread.
+
+ @param thread_no The maximum number of worker threads to use.
+ @param count The number of work items.
+ @param fn The function to call for each item. Receives the worker number and the item index.
+ */
+template<typename F>
+void parallelFor(unsigned thread_no, std::size_t count, F fn) {
+    unsigned workers = std::max(1u, static_cast<unsigned>(std::min<std::size_t>(thread_no, count)));
+
+    if (workers == 1) {
+        for (std::size_t i = 0; i < count; ++i)
+            fn(0u, i);
+        return;
+    }
+
+    std::atomic<std::size_t> next {0};
+    std::vector<std::thread> threads {};
+    for (unsigned w = 0; w < workers; ++w)
+        threads.emplace_back([&next, &fn, count, w]() {
+            for (std::size_t i = next++; i < count; i = next++)
+                fn(w, i);
+        });
+
+    for (std::thread& t: threads)
+        t.join();
+}
+
+#endif /* parallel_hpp */
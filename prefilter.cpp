@@ -0,0 +1,134 @@
+#include "prefilter.hpp"
+
+using namespace llvm;
+
+/**
+ Search a needle in a block of memory. With SSE2 available, 16 candidate positions are checked at
+ once by comparing the first and the last byte of the needle, only positions where both match are
+ compared completely.
+
+ @param data The memory to search.
+ @param size The size of the memory block.
+ @param needle The string to search for.
+ @return `true`, if the needle occurs in the memory block.
+ */
+static bool containsNeedle(const char* data, std::size_t size, StringRef needle) {
+    const std::size_t n = needle.size();
+    if (n == 0 || size < n)
+        return n == 0;
+
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128i first = _mm_set1_epi8(needle.front());
+    const __m128i last = _mm_set1_epi8(needle.back());
+
+    for (; i + n - 1 + 16 <= size; i += 16) {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + n - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+
+        while (mask != 0) {
+            unsigned bit = __builtin_ctz(mask);
+            if (n < 2 || std::memcmp(data + i + bit + 1, needle.data() + 1, n - 2) == 0)
+                return true;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    // remaining tail (or everything without SSE2)
+    for (; i + n <= size; ++i) {
+        const void* hit = std::memchr(data + i, needle.front(), size - n - i + 1);
+        if (!hit)
+            return false;
+        i = static_cast<const char*>(hit) - data;
+        if (std::memcmp(data + i, needle.data(), n) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ Memory-map an IR file and check whether it mentions any of the known channel functions.
+ Only textual IR is inspected, bitcode may store symbol names in a packed encoding and is
+ therefore always accepted. Files that cannot be mapped are accepted as well, so that the
+ IR loader reports the actual problem.
+
+ @param path The path of the file to check.
+ @param needles The mangled symbol fragments of the registered channel functions.
+ @return `false`, if the file definitely contains no send or recv.
+ */
+bool mayContainChannelSymbols(const std::string& path, const std::vector<std::string>& needles) {
+    if (!StringRef(path).endswith(".ll"))
+        return true;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return true;
+
+    struct stat s;
+    if (fstat(fd, &s) != 0 || s.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    std::size_t size = static_cast<std::size_t>(s.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+        return true;
+
+    // the file is read front to back exactly once per needle
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    bool found = false;
+    for (StringRef symbol: needles)
+        if (containsNeedle(static_cast<const char*>(mapped), size, symbol)) {
+            found = true;
+            break;
+        }
+
+    munmap(mapped, size);
+    return found;
+}
+
+
+/**
+ Remove all files from the list that cannot contain any send or recv, so they never reach the
+ IR parser. The files are checked on `thread_no` threads, the order of the list is preserved.
+
+ @param files The candidate files.
+ @param thread_no The number of worker threads to use.
+ @param verbose Print every skipped file.
+ @return The files that have to be parsed.
+ */
+std::forward_list<std::string> prefilter_files(const std::forward_list<std::string>& files, int thread_no, bool verbose) {
+    std::vector<std::string> paths(files.begin(), files.end());
+    std::vector<char> keep(paths.size(), 1);
+
+    // a call to a channel function always references a symbol containing one of the fragments
+    std::vector<std::string> needles = channelSymbolFragments();
+
+    parallelFor(thread_no, paths.size(), [&](unsigned, std::size_t idx) {
+        keep[idx] = mayContainChannelSymbols(paths[idx], needles);
+    });
+
+    std::forward_list<std::string> remaining {};
+    unsigned skipped = 0;
+    // iterate backwards to keep the original order in the forward list
+    for (std::size_t idx = paths.size(); idx-- > 0;) {
+        if (keep[idx])
+            remaining.push_front(paths[idx]);
+        else {
+            ++skipped;
+            if (verbose)
+                std::cout << "Skipped: " << paths[idx] << std::endl;
+        }
+    }
+
+    std::cout << "[INFO] Pre-filter skipped " << skipped << " of " << paths.size() << " files without channel symbols." << std::endl;
+
+    return remaining;
+}
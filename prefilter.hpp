@@ -0,0 +1,29 @@
+#ifndef prefilter_hpp
+#define prefilter_hpp
+
+#include <cstring>
+#include <forward_list>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// memory mapping
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "llvm/ADT/StringRef.h"
+
+#include "parallel.hpp"
+#include "channels.hpp"
+
+// function definitions
+bool mayContainChannelSymbols(const std::string& path, const std::vector<std::string>& needles);
+std::forward_list<std::string> prefilter_files(const std::forward_list<std::string>& files, int thread_no, bool verbose);
+
+#endif /* prefilter_hpp */
@@ -2,148 +2,134 @@
 
 using namespace llvm;
 
-/**
- Function that tries to determine whether the called instruction is a `send` or not.
 
- @param demangled_invoke The demangled name of the function that is being called/invoked
- @return `true`, if the function is a send instruction.
- */
-bool isSend(std::string demangled_invoke) {
-    std::forward_list<std::string> sends {"$LT$std..sync..mpsc..Sender$LT$T$GT$$GT$::send::", \
-        "$LT$ipc_channel..ipc..IpcSender$LT$T$GT$$GT$::send::"};
-
-    for (std::string send_instr: sends) {
-        unsigned long position = demangled_invoke.find(send_instr);
-        if (position != std::string::npos) {
-            // sometimes, a closure is called within the send/recv
-            // -> to avoid wrong matches, check the suffix of the match for another namespace
-            std::string suffix = demangled_invoke.substr(position + send_instr.size(), demangled_invoke.size());
-            if (suffix.find("::") == std::string::npos)
-                return true;
-            else
-                return false;
-        }
-    }
+bool isSend(InvokeInst* ii) {
+    if (!ii->getCalledFunction())
+        return false;
 
-    return false;
+    return classifyCallee(ii->getCalledFunction()).kind == SendCallee;
 }
 
 
-bool isSend(InvokeInst* ii) {
-    if (!ii->getCalledFunction() || !ii->getCalledFunction()->hasName())
-        return false;
-
-    // first, demangle the function name
-    int s;
-    const char* demangled = itaniumDemangle(ii->getCalledFunction()->getName().str().c_str(), nullptr, nullptr, &s);
-    if (s != 0) {
+bool isSend(CallInst* ci) {
+    if (!ci->getCalledFunction())
         return false;
-    }
 
-    return isSend(demangled);
+    return classifyCallee(ci->getCalledFunction()).kind == SendCallee;
 }
 
 
-bool isSend(CallInst* ci) {
-    if (!ci->getCalledFunction() || !ci->getCalledFunction()->hasName())
+bool isResultUnwrap(InvokeInst* ii) {
+    if (!ii->getCalledFunction())
         return false;
 
-    // first, demangle the function name
-    int s;
-    const char* demangled = itaniumDemangle(ci->getCalledFunction()->getName().str().c_str(), nullptr, nullptr, &s);
-    if (s != 0) {
+    return classifyCallee(ii->getCalledFunction()).kind == UnwrapCallee;
+}
+
+
+bool isResultUnwrap(CallInst* ci) {
+    if (!ci->getCalledFunction())
         return false;
-    }
 
-    return isSend(demangled);
+    return classifyCallee(ci->getCalledFunction()).kind == UnwrapCallee;
 }
 
 
-/**
- Function that extracts the type of the message that is being sent over the channel
- by inspecting the type of the sender.
+template<typename CallType>
+static Value* getChannelArgument(CallType* call, const ChannelApi& api) {
+    // the argument to check is shifted by one if the first argument is the return value
+    unsigned first = call->hasStructRetAttr() ? 1 : 0;
+    unsigned count = call->getNumArgOperands();
+    unsigned idx = api.argument < 0 ? count - 1 : first + static_cast<unsigned>(api.argument);
+    if (count == 0 || idx >= count)
+        return nullptr;
 
- Normally, a sender in Rusts LLVM IR is defined as follows:
- std::sync::mpsc::Sender<T>
+    return call->getArgOperand(idx);
+}
 
- This function extracts the transmitted type T, if one exists.
 
- @param struct_name Type name of the sender struct
- @return The name of the sent type, or a `nullptr`.
- */
-const char* getSentType(std::string struct_name) {
-    std::forward_list<std::string> senders {"std::sync::mpsc::Sender<", \
-        "ipc_channel::ipc::IpcSender<"};
-
-    // see if the string starts with "std::sync::mpsc::Sender<" (or the IPC equivalent)
-    // and extract the type thet is being sent
-    for (std::string single_sender: senders) {
-        if (struct_name.find(single_sender) != std::string::npos) {
-            struct_name.erase(0, single_sender.length());
-            struct_name.erase(struct_name.rfind(">"), struct_name.length());
-            return struct_name.c_str();
-        }
-    }
+/**
+ Get the argument of a send or recv call that holds the channel (a pointer to the `Sender` or
+ `Receiver`).
 
+ @param call The call site, a `CallInst` or `InvokeInst`.
+ @param api The channel function that is called.
+ @return The channel argument, or a `nullptr` if the call has no such argument.
+ */
+Value* getChannelArgument(Instruction* call, const ChannelApi& api) {
+    if (CallInst* ci = dyn_cast<CallInst>(call))
+        return getChannelArgument(ci, api);
+    if (InvokeInst* ii = dyn_cast<InvokeInst>(call))
+        return getChannelArgument(ii, api);
     return nullptr;
 }
 
 
+/***************************************** Callee Cache *****************************************/
+
+// every function is classified only once, all analysis phases share the results
+static std::unordered_map<const Function*, CalleeInfo> callee_cache {};
+static std::mutex callee_cache_mutex;
+static std::atomic<unsigned long> callee_lookups {0};
+static std::atomic<unsigned long> callee_hits {0};
+
+
 /**
- Function that tries to determine whether the called instruction is a `recv` or not.
+ Find out whether a function is a send, recv or unwrap.
+ The result is computed once per function and cached afterwards.
 
- @param demangled_invoke The demangled name of the function that is being called/invoked
- @return `true`, if the function is a receive instruction.
+ @param fn The (called) function.
+ @return The classification of the function. The reference stays valid until the function's
+         module is released via `forgetCallees`.
  */
-bool isRecv(std::string demangled_invoke) {
-    std::forward_list<std::string> recvs {"$LT$std..sync..mpsc..Receiver$LT$T$GT$$GT$::recv::", \
-        "$LT$std..sync..mpsc..Receiver$LT$T$GT$$GT$::try_recv::", \
-        "$LT$ipc_channel..ipc..IpcReceiver$LT$T$GT$$GT$::recv::", \
-        "$LT$ipc_channel..ipc..IpcReceiver$LT$T$GT$$GT$::try_recv::", \
-        "std::sync::mpsc::select::Select::handle::"};
-
-    for (std::string recv_instr: recvs) {
-        unsigned long position = demangled_invoke.find(recv_instr);
-        if (position != std::string::npos) {
-            if (recv_instr == "std::sync::mpsc::select::Select::handle::") {
-                return true;
-            }
-            std::string suffix = demangled_invoke.substr(position + recv_instr.size(), demangled_invoke.size());
-            if (suffix.find("::") == std::string::npos)
-                return true;
-            else
-                return false;
+const CalleeInfo& classifyCallee(const Function* fn) {
+    ++callee_lookups;
+    {
+        std::lock_guard<std::mutex> lock(callee_cache_mutex);
+        auto cached = callee_cache.find(fn);
+        if (cached != callee_cache.end()) {
+            ++callee_hits;
+            return cached->second;
         }
     }
 
-    return false;
+    // Rust symbols are classified by their path segments in one pass over the registered
+    // channel APIs, no demangling required
+    CalleeInfo info {OtherCallee, nullptr};
+    RustSymbol symbol;
+    if (fn->hasName() && RustSymbol::parse(fn->getName(), symbol)) {
+        if (const ChannelApi* api = matchChannelApi(symbol)) {
+            info.kind = api->kind;
+            info.api = api;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(callee_cache_mutex);
+    // another thread may have been faster, in that case its entry is kept
+    return callee_cache.insert(std::make_pair(fn, std::move(info))).first->second;
 }
 
 
 /**
- Function that extracts the type of the message that is being received over the channel
- by inspecting the type of the receiver.
+ Remove the cached entries of all functions of a module. Has to be called before a module is
+ released, as its addresses may be reused for functions of other modules.
 
- Normally, a receiver in Rusts LLVM IR is defined as follows:
- std::sync::mpsc::Receiver<T>
+ @param mod The module that is about to be released.
+ */
+void forgetCallees(const Module* mod) {
+    std::lock_guard<std::mutex> lock(callee_cache_mutex);
+    for (const Function& fn: *mod)
+        callee_cache.erase(&fn);
+}
 
- This function extracts the transmitted type T, if one exists.
 
- @param struct_name Type name of the receiver struct
- @return The name of the received type, or a `nullptr`.
- */
-const char* getReceivedType(std::string struct_name) {
-    std::forward_list<std::string> receivers {"std::sync::mpsc::Receiver<", \
-        "ipc_channel::ipc::IpcReceiver<"};
-
-    for (std::string single_receiver: receivers)
-        if (struct_name.find(single_receiver) != std::string::npos) {
-            struct_name.erase(0, single_receiver.length());
-            struct_name.erase(struct_name.rfind(">"), struct_name.length());
-            return struct_name.c_str();
-        }
+unsigned long calleeCacheLookups() {
+    return callee_lookups;
+}
 
-    return nullptr;
+
+unsigned long calleeCacheHits() {
+    return callee_hits;
 }
 
 
@@ -153,11 +139,41 @@ const char* getReceivedType(std::string struct_name) {
 //  --> return the thread names (?) or sth like that as namespace(s)
 //  --> return a list!
 // TODO: Find cross-module stuff
-std::string getNamespace(const Instruction* inst) {
+StringId getNamespace(const Instruction* inst) {
     // This is just a fallback option.
     // If the compiler output is not optimized, this information is available.
     if (!inst->getDebugLoc())
-        return inst->getModule()->getName().str();
+        return intern(inst->getModule()->getName());
+
+    return intern(inst->getFunction()->getSubprogram()->getFilename()); // inst->getDebugLoc()->getFilename()
+}
+
+
+/**
+ Get the source line of an instruction.
+
+ @param inst The instruction in question.
+ @return The line number, or 0 if the instruction carries no debug location.
+ */
+unsigned getLine(const Instruction* inst) {
+    if (!inst->getDebugLoc())
+        return 0;
+
+    return inst->getDebugLoc()->getLine();
+}
+
+
+/**
+ Get a readable name of the function containing an instruction. The name from the debug
+ information is preferred over the mangled symbol name.
+
+ @param inst The instruction in question.
+ @return The name of the surrounding function, owned by the module.
+ */
+StringRef getFunctionName(const Instruction* inst) {
+    const Function* fn = inst->getFunction();
+    if (fn->getSubprogram())
+        return fn->getSubprogram()->getName();
 
-    return inst->getFunction()->getSubprogram()->getFilename().str(); // inst->getDebugLoc()->getFilename().str();
+    return fn->getName();
 }
@@ -1,8 +1,11 @@
 #ifndef properties_hpp
 #define properties_hpp
 
+#include <atomic>
 #include <string>
 #include <forward_list>
+#include <mutex>
+#include <unordered_map>
 
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
@@ -10,19 +13,31 @@
 //Debug Information and Metadata
 #include "llvm/IR/DebugInfoMetadata.h"
 
-// name demangling
-#include "llvm/Demangle/Demangle.h"
-
 #include "types.hpp"
+#include "rustsymbol.hpp"
+#include "interner.hpp"
+#include "channels.hpp"
+
+struct CalleeInfo {
+    CalleeKind kind;
+    const ChannelApi* api;      ///< The matching channel function, `nullptr` for other callees.
+};
+
+const CalleeInfo& classifyCallee(const llvm::Function* fn);
+void forgetCallees(const llvm::Module* mod);
+unsigned long calleeCacheLookups();
+unsigned long calleeCacheHits();
 
-bool isSend(std::string demangled_invoke);
 bool isSend(llvm::InvokeInst* ii);
 bool isSend(llvm::CallInst* ci);
-const char* getSentType(std::string struct_name);
 
-bool isRecv(std::string demangled_invoke);
-const char* getReceivedType(std::string struct_name);
+bool isResultUnwrap(llvm::InvokeInst* ii);
+bool isResultUnwrap(llvm::CallInst* ci);
+
+llvm::Value* getChannelArgument(llvm::Instruction* call, const ChannelApi& api);
 
-std::string getNamespace(const llvm::Instruction* ii);
+StringId getNamespace(const llvm::Instruction* ii);
+unsigned getLine(const llvm::Instruction* inst);
+llvm::StringRef getFunctionName(const llvm::Instruction* inst);
 
 #endif /* properties_hpp */
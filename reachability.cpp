@@ -0,0 +1,338 @@
+#include "reachability.hpp"
+
+using namespace llvm;
+
+
+/**
+ Build the index over all nodes of a store.
+
+ @param store The nodes, the send-after-receive edges are only found for recvs still attached to their instruction.
+ @param node_pairs The matched pairs.
+ */
+MessageReachability::MessageReachability(const NodeStore& store, const std::vector<NodePair>& node_pairs) :
+    successors(store.size()), is_send(store.size(), false), pair_edges(0), receive_edges(0) {
+    for (NodeId id: store.sends())
+        is_send[id] = true;
+
+    for (NodePair pair: node_pairs)
+        successors[pair.first].push_back(pair.second);
+    for (std::vector<NodeId>& edges: successors) {
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        pair_edges += edges.size();
+    }
+
+    addReceiveEdges(store);
+    condense();
+    label();
+}
+
+
+// the sends a recv is followed by: the rest of its function and the functions called from there
+static std::vector<const Instruction*> collectSendsAfter(Instruction* recv, SendSummaries& summaries, std::unordered_map<const Function*, std::vector<const Instruction*>>& callee_sends) {
+    std::vector<const Instruction*> sends {};
+    auto visit = [&](Instruction& inst) {
+        Function* callee = nullptr;
+        if (CallInst* ci = dyn_cast<CallInst>(&inst)) {
+            if (isSend(ci)) {
+                sends.push_back(ci);
+                return;
+            }
+            callee = ci->getCalledFunction();
+        }
+        else if (InvokeInst* ii = dyn_cast<InvokeInst>(&inst)) {
+            if (isSend(ii)) {
+                sends.push_back(ii);
+                return;
+            }
+            callee = ii->getCalledFunction();
+        }
+        if (!callee)
+            return;
+
+        auto known = callee_sends.find(callee);
+        if (known == callee_sends.end()) {
+            summaries.summarize(callee);
+            known = callee_sends.insert(std::make_pair(callee, summaries.sendsOf(callee))).first;
+        }
+        sends.insert(sends.end(), known->second.begin(), known->second.end());
+    };
+
+    // the block of the recv is only visited in full if a loop leads back to it
+    std::unordered_set<BasicBlock*> been_there {};
+    std::vector<BasicBlock*> unvisited {};
+    if (InvokeInst* ii = dyn_cast<InvokeInst>(recv))
+        unvisited.push_back(ii->getNormalDest());
+    else {
+        for (Instruction* inst = recv->getNextNode(); inst; inst = inst->getNextNode())
+            visit(*inst);
+        for (BasicBlock* succ: successors(recv->getParent()))
+            unvisited.push_back(succ);
+    }
+
+    while (!unvisited.empty()) {
+        BasicBlock* bb = unvisited.back();
+        unvisited.pop_back();
+        if (!been_there.insert(bb).second)
+            continue;
+
+        for (Instruction& inst: *bb)
+            visit(inst);
+        for (BasicBlock* succ: successors(bb))
+            unvisited.push_back(succ);
+    }
+
+    return sends;
+}
+
+
+// a recv reaches the sends of its namespace that can run after it
+void MessageReachability::addReceiveEdges(const NodeStore& store) {
+    std::unordered_map<const Instruction*, std::vector<NodeId>> send_nodes {};
+    for (NodeId id: store.sends())
+        if (store[id].instr)
+            send_nodes[store[id].instr].push_back(id);
+
+    SendSummaries summaries {};
+    std::unordered_map<const Function*, std::vector<const Instruction*>> callee_sends {};
+    for (NodeId recv: store.recvs()) {
+        if (!store[recv].instr)
+            continue;
+
+        std::vector<NodeId>& edges = successors[recv];
+        for (const Instruction* send: collectSendsAfter(store[recv].instr, summaries, callee_sends)) {
+            auto nodes = send_nodes.find(send);
+            if (nodes == send_nodes.end())
+                continue;
+            for (NodeId id: nodes->second)
+                if (store[id].nspace == store[recv].nspace)
+                    edges.push_back(id);
+        }
+
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        receive_edges += edges.size();
+    }
+}
+
+
+/**
+ Find the strongly connected components with Tarjan's algorithm (without recursion, the chains
+ of messages can be long). A component is numbered once it is complete, after every component
+ it reaches.
+ */
+void MessageReachability::condense() {
+    const unsigned Unvisited = static_cast<unsigned>(-1);
+    std::size_t node_count = successors.size();
+    std::vector<unsigned> index(node_count, Unvisited);
+    std::vector<unsigned> lowlink(node_count, 0);
+    std::vector<std::size_t> next(node_count, 0);
+    std::vector<bool> on_stack(node_count, false);
+    std::vector<NodeId> stack {};
+    std::vector<NodeId> path {};
+    unsigned counter = 0;
+
+    node_components.assign(node_count, 0);
+    member_begin.assign(1, 0);
+    members.clear();
+
+    auto open = [&](NodeId node) {
+        index[node] = lowlink[node] = counter++;
+        stack.push_back(node);
+        on_stack[node] = true;
+        path.push_back(node);
+    };
+
+    for (NodeId root = 0; root < node_count; ++root) {
+        if (index[root] != Unvisited)
+            continue;
+
+        open(root);
+        while (!path.empty()) {
+            NodeId node = path.back();
+            if (next[node] < successors[node].size()) {
+                NodeId succ = successors[node][next[node]++];
+                if (index[succ] == Unvisited)
+                    open(succ);
+                else if (on_stack[succ])
+                    lowlink[node] = std::min(lowlink[node], index[succ]);
+                continue;
+            }
+
+            path.pop_back();
+            if (!path.empty())
+                lowlink[path.back()] = std::min(lowlink[path.back()], lowlink[node]);
+            if (lowlink[node] != index[node])
+                continue;
+
+            // `node` is the root of a component, its members are on top of the stack
+            unsigned component = static_cast<unsigned>(member_begin.size() - 1);
+            NodeId member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                on_stack[member] = false;
+                node_components[member] = component;
+                members.push_back(member);
+            } while (member != node);
+            member_begin.push_back(members.size());
+        }
+    }
+}
+
+
+/**
+ Label every component with the components it reaches, and with the components reaching it. A
+ component reaches itself and everything its successors reach, which are labeled before it; it
+ is reached by itself and everything reaching its predecessors, which are labeled after it.
+ */
+void MessageReachability::label() {
+    std::size_t component_count = member_begin.size() - 1;
+    std::vector<std::vector<unsigned>> targets(component_count);
+    std::vector<std::vector<unsigned>> sources(component_count);
+    for (unsigned component = 0; component < component_count; ++component)
+        for (std::size_t member = member_begin[component]; member < member_begin[component + 1]; ++member)
+            for (NodeId succ: successors[members[member]])
+                if (node_components[succ] != component) {
+                    targets[component].push_back(node_components[succ]);
+                    sources[node_components[succ]].push_back(component);
+                }
+
+    label_begin.assign(1, 0);
+    intervals.clear();
+    for (unsigned component = 0; component < component_count; ++component) {
+        std::sort(targets[component].begin(), targets[component].end());
+        targets[component].erase(std::unique(targets[component].begin(), targets[component].end()), targets[component].end());
+
+        std::vector<Interval> reached {Interval(component, component)};
+        for (unsigned target: targets[component])
+            reached.insert(reached.end(), intervals.begin() + label_begin[target], intervals.begin() + label_begin[target + 1]);
+        appendLabel(reached, intervals);
+        label_begin.push_back(intervals.size());
+    }
+
+    // the labels of the components reaching one are appended from the last component on
+    source_begin.assign(1, 0);
+    source_intervals.clear();
+    for (std::size_t position = 0; position < component_count; ++position) {
+        unsigned component = static_cast<unsigned>(component_count - 1 - position);
+        std::sort(sources[component].begin(), sources[component].end());
+        sources[component].erase(std::unique(sources[component].begin(), sources[component].end()), sources[component].end());
+
+        std::vector<Interval> reached {Interval(component, component)};
+        for (unsigned source: sources[component]) {
+            std::size_t source_position = component_count - 1 - source;
+            reached.insert(reached.end(), source_intervals.begin() + source_begin[source_position], source_intervals.begin() + source_begin[source_position + 1]);
+        }
+        appendLabel(reached, source_intervals);
+        source_begin.push_back(source_intervals.size());
+    }
+}
+
+
+// append a label, merging its overlapping and adjacent intervals
+void MessageReachability::appendLabel(std::vector<Interval>& reached, std::vector<Interval>& labels) {
+    std::sort(reached.begin(), reached.end());
+
+    std::size_t first = labels.size();
+    for (const Interval& interval: reached) {
+        if (labels.size() > first && interval.first <= labels.back().second + 1)
+            labels.back().second = std::max(labels.back().second, interval.second);
+        else
+            labels.push_back(interval);
+    }
+}
+
+
+bool MessageReachability::inLabel(unsigned component, unsigned target) const {
+    auto begin = intervals.begin() + label_begin[component];
+    auto end = intervals.begin() + label_begin[component + 1];
+    auto interval = std::lower_bound(begin, end, target, [](const Interval& interval, unsigned value) {
+        return interval.second < value;
+    });
+    return interval != end && interval->first <= target;
+}
+
+
+/**
+ Check whether a message graph path leads from one node to another.
+
+ @param from The node to start at.
+ @param to The node to reach.
+ @return `true`, if `to` can be reached from `from`, every node reaches itself.
+ */
+bool MessageReachability::reaches(NodeId from, NodeId to) const {
+    return inLabel(node_components[from], node_components[to]);
+}
+
+
+/**
+ Get the sends a node can cause, through any number of messages.
+
+ @param from The node to start at.
+ @return The sends reachable from `from` (other than `from` itself), ascending.
+ */
+std::vector<NodeId> MessageReachability::downstreamSends(NodeId from) const {
+    std::vector<NodeId> sends {};
+    unsigned component = node_components[from];
+    for (std::size_t idx = label_begin[component]; idx < label_begin[component + 1]; ++idx)
+        for (unsigned target = intervals[idx].first; target <= intervals[idx].second; ++target)
+            for (std::size_t member = member_begin[target]; member < member_begin[target + 1]; ++member)
+                if (is_send[members[member]] && members[member] != from)
+                    sends.push_back(members[member]);
+
+    std::sort(sends.begin(), sends.end());
+    return sends;
+}
+
+
+/**
+ Get the sends that can cause a node, through any number of messages.
+
+ @param to The node to reach.
+ @return The sends `to` is reachable from (other than `to` itself), ascending.
+ */
+std::vector<NodeId> MessageReachability::upstreamSenders(NodeId to) const {
+    std::vector<NodeId> senders {};
+    std::size_t position = componentCount() - 1 - node_components[to];
+    for (std::size_t idx = source_begin[position]; idx < source_begin[position + 1]; ++idx)
+        for (unsigned source = source_intervals[idx].first; source <= source_intervals[idx].second; ++source)
+            for (std::size_t member = member_begin[source]; member < member_begin[source + 1]; ++member)
+                if (is_send[members[member]] && members[member] != to)
+                    senders.push_back(members[member]);
+
+    std::sort(senders.begin(), senders.end());
+    return senders;
+}
+
+
+/**
+ Write the sends every send can cause, next to the message graph. Every line lists a send
+ followed by its downstream sends, as `<node id> <namespace>:<line>`; the node IDs are the port
+ names of the graph.
+
+ @param store The nodes.
+ @param reachability The index of the nodes.
+ @param output_path The path of the file.
+ */
+void exportReachability(const NodeStore& store, const MessageReachability& reachability, const std::string& output_path) {
+    std::ofstream reach_file(output_path.c_str());
+    if (!reach_file.good()) {
+        errs() << "[ERROR] Could not open the reachability file `" << output_path << "`!\n";
+        return;
+    }
+
+    reach_file << "# send -> the sends it can cause (node id namespace:line)" << std::endl;
+    for (NodeId send: store.sends()) {
+        std::vector<NodeId> downstream = reachability.downstreamSends(send);
+        if (downstream.empty())
+            continue;
+
+        reach_file << send << " " << internedString(store[send].nspace).str() << ":" << store[send].line << " ->";
+        for (std::size_t idx = 0; idx < downstream.size(); ++idx)
+            reach_file << (idx == 0 ? " " : ", ") << downstream[idx] << " " << internedString(store[downstream[idx]].nspace).str() << ":" << store[downstream[idx]].line;
+        reach_file << std::endl;
+    }
+
+    outs() << "[INFO] Reachability written to " << output_path << "\n";
+}
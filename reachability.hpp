@@ -0,0 +1,75 @@
+#ifndef reachability_hpp
+#define reachability_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "types.hpp"
+#include "nodestore.hpp"
+#include "properties.hpp"
+#include "summary.hpp"
+
+
+/**
+ Reachability between the sends and recvs of the message graph. A send reaches the recvs it is
+ matched with, a recv reaches the sends of its component (namespace) that can run after it: the
+ sends following it in its function and in the functions called from there, as the guided
+ analysis finds them.
+
+ The graph is condensed into its strongly connected components, numbered in reverse topological
+ order. Every component is labeled with the components it reaches as a list of intervals of their
+ numbers; as the numbers follow the depth-first search, the components below one are mostly
+ numbered consecutively and few intervals are needed. A query is a binary search in one label.
+ The components reaching each component are labeled the same way, on the reversed graph.
+ */
+class MessageReachability {
+public:
+    MessageReachability(const NodeStore& store, const std::vector<NodePair>& node_pairs);
+
+    bool reaches(NodeId from, NodeId to) const;
+    std::vector<NodeId> downstreamSends(NodeId from) const;
+    std::vector<NodeId> upstreamSenders(NodeId to) const;
+
+    std::size_t pairEdges() const { return pair_edges; }
+    std::size_t receiveEdges() const { return receive_edges; }
+    std::size_t componentCount() const { return member_begin.size() - 1; }
+    std::size_t intervalCount() const { return intervals.size() + source_intervals.size(); }
+
+private:
+    typedef std::pair<unsigned, unsigned> Interval;     ///< Component numbers, both included.
+
+    std::vector<std::vector<NodeId>> successors;
+    std::vector<bool> is_send;
+    std::size_t pair_edges;
+    std::size_t receive_edges;
+
+    std::vector<unsigned> node_components;
+    std::vector<std::size_t> member_begin;      ///< The members of component `c` are `members[member_begin[c]..member_begin[c + 1]]`.
+    std::vector<NodeId> members;
+    std::vector<std::size_t> label_begin;       ///< The label of component `c` is `intervals[label_begin[c]..label_begin[c + 1]]`.
+    std::vector<Interval> intervals;
+    std::vector<std::size_t> source_begin;      ///< The components reaching `c` are `source_intervals[source_begin[p]..source_begin[p + 1]]`, `p` counting from the last component.
+    std::vector<Interval> source_intervals;
+
+    void addReceiveEdges(const NodeStore& store);
+    void condense();
+    void label();
+    static void appendLabel(std::vector<Interval>& reached, std::vector<Interval>& labels);
+    bool inLabel(unsigned component, unsigned target) const;
+};
+
+void exportReachability(const NodeStore& store, const MessageReachability& reachability, const std::string& output_path);
+
+#endif /* reachability_hpp */
@@ -0,0 +1,111 @@
+#include "rustsymbol.hpp"
+
+using namespace llvm;
+
+
+static bool isHashSegment(StringRef segment) {
+    if (segment.size() != 17 || segment.front() != 'h')
+        return false;
+
+    for (char c: segment.drop_front(1))
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+            return false;
+
+    return true;
+}
+
+
+/**
+ Split a mangled Rust symbol into its path segments. Suffixes appended by LLVM after the closing
+ `E` (like `.llvm.1234`) are ignored.
+
+ @param mangled The mangled symbol name, e.g. `_ZN3std6thread5spawn17h0123456789abcdefE`.
+ @param symbol Receives the segments.
+ @return `false`, if the name is not a Rust symbol in the legacy mangling scheme.
+ */
+bool RustSymbol::parse(StringRef mangled, RustSymbol& symbol) {
+    symbol.segments.clear();
+    symbol.path_size = 0;
+
+    StringRef rest = mangled;
+    if (rest.startswith("__ZN"))
+        rest = rest.drop_front(4);
+    else if (rest.startswith("_ZN"))
+        rest = rest.drop_front(3);
+    else
+        return false;
+
+    while (!rest.empty() && rest.front() != 'E') {
+        std::size_t length = 0;
+        std::size_t digits = 0;
+        while (digits < rest.size() && rest[digits] >= '0' && rest[digits] <= '9') {
+            length = length * 10 + (rest[digits] - '0');
+            ++digits;
+        }
+
+        if (digits == 0 || length == 0 || digits + length > rest.size())
+            return false;
+
+        symbol.segments.push_back(rest.substr(digits, length));
+        rest = rest.drop_front(digits + length);
+    }
+
+    if (rest.empty() || symbol.segments.empty())
+        return false;
+
+    symbol.path_size = symbol.segments.size();
+    if (symbol.path_size > 1 && isHashSegment(symbol.segments.back()))
+        --symbol.path_size;
+
+    return true;
+}
+
+
+/**
+ Translate the code of an escape sequence (the part between the dollar signs) into a character.
+
+ @param code The escape code, e.g. `LT` or `u20`.
+ @return The character, or 0 for unknown codes.
+ */
+char RustSegmentDecoder::decodeEscape(StringRef code) {
+    if (code == "LT") return '<';
+    if (code == "GT") return '>';
+    if (code == "C") return ',';
+    if (code == "RF") return '&';
+    if (code == "BP") return '*';
+    if (code == "SP") return '@';
+    if (code == "LP") return '(';
+    if (code == "RP") return ')';
+
+    // arbitrary characters as `u` followed by their hex code
+    if (code.size() > 1 && code.front() == 'u') {
+        unsigned value;
+        if (!code.drop_front(1).getAsInteger(16, value) && value > 0 && value < 128)
+            return static_cast<char>(value);
+    }
+
+    return 0;
+}
+
+
+/**
+ Compare a mangled path segment with a plain string without decoding the segment into a
+ temporary buffer.
+
+ @param raw_segment The segment as found in the mangled name, e.g. `_$LT$core..result..Result$LT$T$C$$u20$E$GT$$GT$`.
+ @param decoded The string to compare with, e.g. `<core::result::Result<T, E>>`.
+ @return `true`, if the decoded segment equals the string.
+ */
+bool segmentEquals(StringRef raw_segment, StringRef decoded) {
+    RustSegmentDecoder decoder(raw_segment);
+    std::size_t pos = 0;
+    char c;
+
+    while (decoder.next(c)) {
+        if (pos >= decoded.size() || decoded[pos] != c)
+            return false;
+        ++pos;
+    }
+
+    return pos == decoded.size();
+}
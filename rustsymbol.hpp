@@ -0,0 +1,88 @@
+#ifndef rustsymbol_hpp
+#define rustsymbol_hpp
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+/**
+ A Rust symbol in the legacy mangling scheme (`_ZN<len><segment>...E`), split into its path
+ segments. The segments point into the mangled name, nothing is copied or allocated (as long as
+ the path has no more than 16 segments). Segments still contain the escape sequences used by
+ rustc (`$LT$`, `..`, ...), use a `RustSegmentDecoder` to read the actual characters.
+ */
+class RustSymbol {
+public:
+    static bool parse(llvm::StringRef mangled, RustSymbol& symbol);
+
+    /// The number of path segments, without the trailing hash segment.
+    std::size_t size() const { return path_size; }
+    llvm::StringRef operator[](std::size_t idx) const { return segments[idx]; }
+    bool hasHash() const { return segments.size() > path_size; }
+
+private:
+    llvm::SmallVector<llvm::StringRef, 16> segments;
+    std::size_t path_size = 0;
+};
+
+
+/**
+ Decodes the escape sequences of a single (mangled) path segment on the fly, one character
+ at a time: `$LT$` becomes `<`, `..` becomes `::`, `$u20$` becomes a space and so on.
+ */
+class RustSegmentDecoder {
+public:
+    explicit RustSegmentDecoder(llvm::StringRef raw) : rest(raw), pending(0) {
+        // rustc prefixes segments starting with an escape sequence with an underscore
+        if (rest.startswith("_$"))
+            rest = rest.drop_front(1);
+    }
+
+    /**
+     Get the next decoded character.
+
+     @param c Receives the character.
+     @return `false`, if the end of the segment has been reached.
+     */
+    bool next(char& c) {
+        if (pending) {
+            c = pending;
+            pending = 0;
+            return true;
+        }
+        if (rest.empty())
+            return false;
+
+        if (rest.startswith("..")) {
+            rest = rest.drop_front(2);
+            c = ':';
+            pending = ':';
+            return true;
+        }
+        if (rest.front() == '$') {
+            std::size_t end = rest.find('$', 1);
+            if (end != llvm::StringRef::npos) {
+                char decoded = decodeEscape(rest.slice(1, end));
+                if (decoded) {
+                    rest = rest.drop_front(end + 1);
+                    c = decoded;
+                    return true;
+                }
+            }
+        }
+
+        c = rest.front();
+        rest = rest.drop_front(1);
+        return true;
+    }
+
+private:
+    static char decodeEscape(llvm::StringRef code);
+
+    llvm::StringRef rest;
+    char pending;
+};
+
+
+bool segmentEquals(llvm::StringRef raw_segment, llvm::StringRef decoded);
+
+#endif /* rustsymbol_hpp */
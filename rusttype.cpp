@@ -0,0 +1,264 @@
+#include "rusttype.hpp"
+
+using namespace llvm;
+
+
+static bool isSegmentChar(char c) {
+    // closures and other compiler generated items show up as `{{closure}}`
+    return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '{' || c == '}' || c == '#';
+}
+
+
+// skip a lifetime like `'a` or `'static`
+static void skipLifetime(StringRef& rest) {
+    rest = rest.drop_front(1);
+    while (!rest.empty() && isSegmentChar(rest.front()))
+        rest = rest.drop_front(1);
+    rest = rest.ltrim();
+}
+
+
+/**
+ Parse a type name into a type tree. Names the parser does not understand become a single
+ opaque node. Every name is parsed only once.
+
+ @param name The interned type name.
+ @return The ID of the type tree.
+ */
+TypeId RustTypeTable::parse(StringId name) {
+    auto known = parsed.find(name);
+    if (known != parsed.end())
+        return known->second;
+
+    StringRef rest = internedString(name);
+    TypeId id;
+    if (!parseType(rest, id) || !rest.trim().empty())
+        id = add(RustType {OpaqueKind, {name}, {}});
+
+    parsed[name] = id;
+    return id;
+}
+
+
+TypeId RustTypeTable::add(RustType type) {
+    auto known = ids.find(type);
+    if (known != ids.end())
+        return known->second;
+
+    TypeId id = static_cast<TypeId>(types.size());
+    ids.insert(std::make_pair(type, id));
+    types.push_back(std::move(type));
+    return id;
+}
+
+
+/**
+ Parse a single type from the front of a string.
+
+ @param rest The string, the parsed type is removed from it.
+ @param id Receives the ID of the type tree.
+ @return `false`, if the string does not start with a type the parser understands.
+ */
+bool RustTypeTable::parseType(StringRef& rest, TypeId& id) {
+    rest = rest.ltrim();
+    if (rest.empty())
+        return false;
+
+    RustType type {PathKind, {}, {}};
+    TypeId inner;
+
+    if (rest.front() == '&' || rest.front() == '*') {
+        type.kind = rest.front() == '&' ? RefKind : PtrKind;
+        rest = rest.drop_front(1).ltrim();
+        if (!rest.empty() && rest.front() == '\'')
+            skipLifetime(rest);
+        if (rest.startswith("mut ") || rest.startswith("const ")) {
+            StringRef qualifier = rest.substr(0, rest.find(' '));
+            type.path.push_back(intern(qualifier));
+            rest = rest.drop_front(qualifier.size());
+        }
+        if (!parseType(rest, inner))
+            return false;
+        type.args.push_back(inner);
+    }
+    else if (rest.front() == '(') {
+        type.kind = TupleKind;
+        rest = rest.drop_front(1);
+        if (!parseList(rest, ')', type.args))
+            return false;
+    }
+    else if (rest.front() == '[') {
+        rest = rest.drop_front(1);
+        if (!parseType(rest, inner))
+            return false;
+        type.args.push_back(inner);
+
+        rest = rest.ltrim();
+        type.kind = SliceKind;
+        if (rest.startswith(";")) {
+            type.kind = ArrayKind;
+            std::size_t end = rest.find(']');
+            if (end == StringRef::npos)
+                return false;
+            type.path.push_back(intern(rest.slice(1, end).trim()));
+            rest = rest.drop_front(end);
+        }
+        if (!rest.startswith("]"))
+            return false;
+        rest = rest.drop_front(1);
+    }
+    else if (rest.startswith("fn(")) {
+        type.kind = FnKind;
+        rest = rest.drop_front(3);
+        if (!parseList(rest, ')', type.args))
+            return false;
+
+        rest = rest.ltrim();
+        if (rest.startswith("->")) {
+            rest = rest.drop_front(2);
+            if (!parseType(rest, inner))
+                return false;
+            type.path.push_back(intern("->"));
+            type.args.push_back(inner);
+        }
+    }
+    else {
+        // trait objects are named by their trait
+        if (rest.startswith("dyn "))
+            rest = rest.drop_front(4);
+        return parsePath(rest, id);
+    }
+
+    id = add(std::move(type));
+    return true;
+}
+
+
+/**
+ Parse a (possibly generic) path like `core::result::Result<T, E>`.
+ */
+bool RustTypeTable::parsePath(StringRef& rest, TypeId& id) {
+    RustType type {PathKind, {}, {}};
+
+    while (true) {
+        std::size_t length = 0;
+        while (length < rest.size() && isSegmentChar(rest[length]))
+            ++length;
+        StringRef segment = rest.take_front(length);
+        if (segment.empty())
+            return false;
+        type.path.push_back(intern(segment));
+        rest = rest.drop_front(segment.size());
+
+        if (rest.startswith("<")) {
+            rest = rest.drop_front(1);
+            if (!parseList(rest, '>', type.args))
+                return false;
+        }
+
+        if (!rest.startswith("::"))
+            break;
+        rest = rest.drop_front(2);
+    }
+
+    id = add(std::move(type));
+    return true;
+}
+
+
+/**
+ Parse a comma separated list of types up to the closing character. Lifetimes are skipped.
+ */
+bool RustTypeTable::parseList(StringRef& rest, char close, std::vector<TypeId>& items) {
+    while (true) {
+        rest = rest.ltrim();
+        if (rest.empty())
+            return false;
+        if (rest.front() == close) {
+            rest = rest.drop_front(1);
+            return true;
+        }
+
+        if (rest.front() == '\'')
+            skipLifetime(rest);
+        else {
+            TypeId item;
+            if (!parseType(rest, item))
+                return false;
+            items.push_back(item);
+        }
+
+        rest = rest.ltrim();
+        if (rest.startswith(","))
+            rest = rest.drop_front(1);
+        else if (rest.empty() || rest.front() != close)
+            return false;
+    }
+}
+
+
+/**
+ Check whether a sent and a received type match. Paths match on segment boundaries, the shorter
+ path has to be a suffix of the longer one (`weatherstation::Weather` matches `Weather`, but
+ `NotWeather` does not). Generic arguments and other elements have to match pairwise.
+
+ @param a The first type.
+ @param b The second type.
+ @return `true`, if the types match.
+ */
+bool RustTypeTable::matches(TypeId a, TypeId b) const {
+    if (a == b)
+        return true;
+
+    const RustType& x = types[a];
+    const RustType& y = types[b];
+    if (x.kind != y.kind || x.kind == OpaqueKind || x.args.size() != y.args.size())
+        return false;
+
+    if (x.kind == PathKind) {
+        std::size_t shorter = std::min(x.path.size(), y.path.size());
+        if (!std::equal(x.path.end() - shorter, x.path.end(), y.path.end() - shorter))
+            return false;
+    }
+    else if (x.path != y.path)
+        return false;
+
+    for (std::size_t idx = 0; idx < x.args.size(); ++idx)
+        if (!matches(x.args[idx], y.args[idx]))
+            return false;
+
+    return true;
+}
+
+
+/**
+ Check whether a type is the unit type `()` or a `Result` or `Option` of it.
+ */
+bool RustTypeTable::isUnitWrapper(TypeId id) const {
+    const RustType& type = types[id];
+    if (type.kind == TupleKind)
+        return type.args.empty();
+    if (type.kind != PathKind || type.args.empty() || type.path.size() != 3)
+        return false;
+
+    StringRef crate = internedString(type.path[0]);
+    StringRef module = internedString(type.path[1]);
+    StringRef name = internedString(type.path[2]);
+    bool wrapper = (crate == "core" || crate == "std") && ((module == "result" && name == "Result") || (module == "option" && name == "Option"));
+
+    const RustType& wrapped = types[type.args[0]];
+    return wrapper && wrapped.kind == TupleKind && wrapped.args.empty();
+}
+
+
+/**
+ Get a key that is equal for all types that may match each other: the kind, the number of
+ elements and, for paths, the last segment.
+ */
+std::uint64_t RustTypeTable::indexKey(TypeId id) const {
+    const RustType& type = types[id];
+    std::uint64_t key = (static_cast<std::uint64_t>(type.kind) << 56) | (static_cast<std::uint64_t>(type.args.size() & 0xffffff) << 32);
+    if (type.kind == PathKind || type.kind == OpaqueKind)
+        key |= type.path.back();
+    return key;
+}
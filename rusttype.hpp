@@ -0,0 +1,69 @@
+#ifndef rusttype_hpp
+#define rusttype_hpp
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+
+#include "interner.hpp"
+
+/// Index of a type tree in a `RustTypeTable`.
+typedef unsigned TypeId;
+
+enum RustTypeKind {
+    PathKind,       ///< A named type, e.g. `core::result::Result<T, E>`.
+    TupleKind,      ///< A tuple, `()` is the unit type.
+    RefKind,        ///< A reference, `&T` or `&mut T`.
+    PtrKind,        ///< A raw pointer, `*const T` or `*mut T`.
+    ArrayKind,      ///< An array, `[T; N]`.
+    SliceKind,      ///< A slice, `[T]`.
+    FnKind,         ///< A function pointer, `fn(A, B) -> R`.
+    OpaqueKind      ///< Anything the parser does not understand, compared by its text.
+};
+
+/**
+ A node of a type tree. Equal trees are stored only once, so two types are equal exactly if
+ their IDs are equal.
+ */
+struct RustType {
+    RustTypeKind kind;
+    std::vector<StringId> path;     ///< Path segments, the qualifier (`mut`, `const`) of references and pointers, the array length, or the text of an opaque type.
+    std::vector<TypeId> args;       ///< Generic arguments, tuple/array/pointee elements, or parameters (and return type) of a function.
+
+    bool operator<(const RustType& other) const {
+        return std::tie(kind, path, args) < std::tie(other.kind, other.path, other.args);
+    }
+};
+
+
+/**
+ Parses the type names extracted from the channel structs (like `core::result::Result<(), std::io::Error>`)
+ into interned type trees and matches them structurally.
+ */
+class RustTypeTable {
+public:
+    TypeId parse(StringId name);
+    const RustType& operator[](TypeId id) const { return types[id]; }
+
+    bool matches(TypeId a, TypeId b) const;
+    bool isUnitWrapper(TypeId id) const;
+    std::uint64_t indexKey(TypeId id) const;
+
+private:
+    TypeId add(RustType type);
+    bool parseType(llvm::StringRef& rest, TypeId& id);
+    bool parsePath(llvm::StringRef& rest, TypeId& id);
+    bool parseList(llvm::StringRef& rest, char close, std::vector<TypeId>& items);
+
+    std::vector<RustType> types;
+    std::map<RustType, TypeId> ids;
+    std::unordered_map<StringId, TypeId> parsed;
+};
+
+#endif /* rusttype_hpp */
@@ -3,132 +3,223 @@
 using namespace llvm;
 
 
-std::pair<std::forward_list<MessagingNode>, std::forward_list<MessagingNode>> scan_module(std::unique_ptr<Module>& module) {
-    std::forward_list<MessagingNode> sends {};
-    std::forward_list<MessagingNode> recvs {};
+/**
+ Check whether a module knows any `send` or `recv` function. This only looks at the function
+ names and therefore works on lazily loaded modules without materializing any body.
+
+ @param module The module to inspect.
+ @return `true`, if a function of the module is a send or recv.
+ */
+bool hasChannelFunctions(std::unique_ptr<Module>& module) {
+    for (Function& func: module->getFunctionList()) {
+        CalleeKind kind = classifyCallee(&func).kind;
+        if (kind == SendCallee || kind == RecvCallee)
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ Get the name of the channel struct a send or recv call operates on.
+
+ @param call The call site, a `CallInst` or `InvokeInst`.
+ @param api The channel function that is called.
+ @return The struct name (owned by the context), or an empty string if the argument is no pointer to a named struct.
+ */
+StringRef getChannelStructName(Instruction* call, const ChannelApi& api) {
+    Value* channel_arg = getChannelArgument(call, api);
+    if (!channel_arg)
+        return StringRef();
+
+    PointerType* ptr = dyn_cast<PointerType>(channel_arg->getType());
+    StructType* channel = ptr ? dyn_cast<StructType>(ptr->getElementType()) : nullptr;
+    if (!channel || !channel->hasName())
+        return StringRef();
+
+    return channel->getName();
+}
+
+
+/**
+ Create the node for a send or recv call site. Works on `CallInst`s and `InvokeInst`s alike.
+
+ @param call The call site.
+ @param callee The classification of the called function.
+ @param store The node store to extend.
+ */
+template<typename CallType>
+void addNode(CallType* call, const CalleeInfo& callee, NodeStore& store) {
+    if (callee.kind != SendCallee && callee.kind != RecvCallee)
+        return;
+
+    // ignore any failures when extracting the types by simply skipping the value
+    StringId type;
+    if (!getMessageType(*callee.api, getChannelStructName(call, *callee.api), type))
+        return;
+
+    // Instruction *is* sending something
+    if (callee.kind == SendCallee)
+        store.addSend(call, type, getNamespace(call), getLine(call), getFunctionName(call), -1);
+    else {
+        StringId nspace = getNamespace(call);
+
+        // ignore recvs from libstd/sync/mpsc/select.rs
+        // selects are a (currently) unstable feature and a separate way to receive messages
+        // these recvs are recognized separately, so we have to ignore them here explicitly
+        if (internedString(nspace).find("libstd/sync/mpsc/select.rs") == StringRef::npos) {
+            store.addRecv(call, type, nspace, getLine(call), getFunctionName(call), Unchecked);
+        }
+    }
+}
 
+
+/**
+ Scan a module by visiting every instruction of every function. Lazily loaded functions are
+ materialized one at a time, which keeps the memory footprint low for bitcode input.
+
+ @param module The module to scan.
+ @param release_unused Drop lazily loaded bodies again that contain no send or recv.
+ @param store The node store to extend.
+ */
+void scan_instructions(std::unique_ptr<Module>& module, bool release_unused, NodeStore& store) {
     // Iterate through all functions through all basic blocks over every instruction within the modules
-    for (Function& func: module->getFunctionList())
+    for (Function& func: module->getFunctionList()) {
+        // bodies of lazily loaded functions are read just before they are scanned
+        bool lazy = func.isMaterializable();
+        if (!ensureMaterialized(&func))
+            continue;
+
+        // remember the size of the store to find out whether this function added any nodes
+        std::size_t known_nodes = store.size();
+
         for (BasicBlock& bb: func.getBasicBlockList()) {
             // check the terminator of the basic block (could be a `send` invocation)
             if (InvokeInst* ii = dyn_cast<InvokeInst>(bb.getTerminator()))
                 // check if it's an direct function invocation that has a name
-                if (ii->getCalledFunction() && ii->getCalledFunction()->hasName()) {
-                    // compare the demangled function name to find out whether it's a send or recv
-                    int s;
-                    const char* demangled_name = itaniumDemangle(ii->getCalledFunction()->getName().str().c_str(), nullptr, nullptr, &s);
-                    if (s != 0)
-                        continue;
-
-                    // Instruction *is* sending something
-                    if (isSend(demangled_name)) {
-                        // the argument to check is determined by whether the first argument is the return value or not
-                        std::string struct_name;
-                        if (ii->hasStructRetAttr())
-                            struct_name = cast<PointerType>(ii->getArgOperand(1)->getType())->getElementType()->getStructName().str();
-                        else
-                            struct_name = cast<PointerType>(ii->getArgOperand(0)->getType())->getElementType()->getStructName().str();
-
-                        // ignore any failures when extracting the types by simply skipping the value
-                        if (const char* sent_type = getSentType(std::move(struct_name)))
-                            sends.push_front(MessagingNode {ii, sent_type, getNamespace(ii), .assignment = -1});
-                        else
-                            continue;
-                    }
-                    else if (isRecv(demangled_name)) {
-                        // functionality similar to the branch above
-                        std::string struct_name;
-                        if (ii->hasStructRetAttr())
-                            struct_name = cast<PointerType>(ii->getArgOperand(1)->getType())->getElementType()->getStructName().str();
-                        else
-                            struct_name = cast<PointerType>(ii->getArgOperand(0)->getType())->getElementType()->getStructName().str();
-
-                        // select! instructions are special. They take the receiver as last argument ¯\_(ツ)_/¯
-                        if (struct_name == "std::sync::mpsc::select::Select")
-                            struct_name = cast<PointerType>(ii->getArgOperand(ii->getNumArgOperands() - 1)->getType())->getElementType()->getStructName().str();
-
-                        if (const char* recv_type = getReceivedType(std::move(struct_name))) {
-                            std::string type_received = recv_type;
-                            std::string nspace = getNamespace(ii);
-
-                            // ignore recvs from libstd/sync/mpsc/select.rs
-                            // selects are a (currently) unstable feature and a separate way to receive messages
-                            // these recvs are recognized separately, so we have to ignore them here explicitly
-                            if (nspace.find("libstd/sync/mpsc/select.rs") == std::string::npos) {
-                                recvs.push_front(MessagingNode {ii, type_received, nspace, .usage = std::make_pair(Unchecked, (Instruction*) nullptr)});
-                            }
-                        }
-                        else
-                            continue;
-                    }
+                if (ii->getCalledFunction())
+                    addNode(ii, classifyCallee(ii->getCalledFunction()), store);
+
+            for (Instruction& inst: bb.getInstList())
+                if (CallInst* ci = dyn_cast<CallInst>(&inst))
+                    if (ci->getCalledFunction())
+                        addNode(ci, classifyCallee(ci->getCalledFunction()), store);
+        }
+
+        // drop lazily loaded bodies again if nothing in them talks to a channel
+        if (lazy && release_unused && store.size() == known_nodes)
+            func.deleteBody();
+    }
+}
+
+
+/**
+ Scan a module by classifying every function once and visiting only the call sites of the
+ send and recv functions (through their users). The work done depends on the number of
+ functions and channel call sites instead of the total size of the IR.
+ Requires a completely materialized module, as unmaterialized bodies do not show up as users.
+
+ The nodes are reported in the same order as `scan_instructions` would report them.
+
+ @param module The module to scan.
+ @param store The node store to extend.
+ */
+void scan_call_sites(std::unique_ptr<Module>& module, NodeStore& store) {
+    std::unordered_map<const Instruction*, const CalleeInfo*> call_sites {};
+    std::unordered_set<const Function*> callers {};
+
+    for (Function& func: module->getFunctionList()) {
+        const CalleeInfo& callee = classifyCallee(&func);
+        if (callee.kind != SendCallee && callee.kind != RecvCallee)
+            continue;
+
+        // only direct calls count, just like in the instruction-based scan
+        for (User* u: func.users()) {
+            if (CallInst* ci = dyn_cast<CallInst>(u)) {
+                if (ci->getCalledFunction() == &func) {
+                    call_sites[ci] = &callee;
+                    callers.insert(ci->getFunction());
                 }
-            for (Instruction& inst: bb.getInstList()) {
-                if (CallInst* ci = dyn_cast<CallInst>(&inst)) {
-                    if (!ci->getCalledFunction() || !ci->getCalledFunction()->hasName())
-                        continue;
-                    // compare the demangled function name to find out whether it's a send or recv
-                    int s;
-                    const char* demangled_name = itaniumDemangle(ci->getCalledFunction()->getName().str().c_str(), nullptr, nullptr, &s);
-                    if (s != 0)
-                        continue;
-
-                    // Instruction *is* sending something
-                    if (isSend(demangled_name)) {
-                        // the argument to check is determined by whether the first argument is the return value or not
-                        std::string struct_name;
-                        if (ci->hasStructRetAttr())
-                            struct_name = cast<PointerType>(ci->getArgOperand(1)->getType())->getElementType()->getStructName().str();
-                        else
-                            struct_name = cast<PointerType>(ci->getArgOperand(0)->getType())->getElementType()->getStructName().str();
-
-                        // ignore any failures when extracting the types by simply skipping the value
-                        if (const char* sent_type = getSentType(std::move(struct_name)))
-                            sends.push_front(MessagingNode {ci, sent_type, getNamespace(ci), .assignment = -1});
-                        else
-                            continue;
-                    }
-                    else if (isRecv(demangled_name)) {
-                        // functionality similar to the branch above
-                        std::string struct_name;
-                        if (ci->hasStructRetAttr())
-                            struct_name = cast<PointerType>(ci->getArgOperand(1)->getType())->getElementType()->getStructName().str();
-                        else
-                            struct_name = cast<PointerType>(ci->getArgOperand(0)->getType())->getElementType()->getStructName().str();
-
-                        if (const char* recv_type = getReceivedType(std::move(struct_name))) {
-                            std::string type_received = recv_type;
-                            std::string nspace = getNamespace(ci);
-
-                            // ignore recvs from libstd/sync/mpsc/select.rs
-                            // selects are a (currently) unstable feature and a separate way to receive messages
-                            // these recvs are recognized separately, so we have to ignore them here explicitly
-                            if (nspace.find("libstd/sync/mpsc/select.rs") == std::string::npos) {
-                                recvs.push_front(MessagingNode {ci, type_received, nspace, .usage = std::make_pair(Unchecked, (Instruction*) nullptr)});
-                            }
-                        }
-                        else
-                            continue;
-                    }
+            }
+            else if (InvokeInst* ii = dyn_cast<InvokeInst>(u)) {
+                if (ii->getCalledFunction() == &func) {
+                    call_sites[ii] = &callee;
+                    callers.insert(ii->getFunction());
                 }
             }
         }
+    }
+
+    if (call_sites.empty())
+        return;
+
+    // emit the nodes in program order, visiting only the functions that contain call sites
+    for (Function& func: module->getFunctionList()) {
+        if (callers.find(&func) == callers.end())
+            continue;
+
+        for (BasicBlock& bb: func.getBasicBlockList()) {
+            if (InvokeInst* ii = dyn_cast<InvokeInst>(bb.getTerminator())) {
+                auto site = call_sites.find(ii);
+                if (site != call_sites.end())
+                    addNode(ii, *site->second, store);
+            }
 
-    return std::make_pair(sends, recvs);
+            for (Instruction& inst: bb.getInstList())
+                if (CallInst* ci = dyn_cast<CallInst>(&inst)) {
+                    auto site = call_sites.find(ci);
+                    if (site != call_sites.end())
+                        addNode(ci, *site->second, store);
+                }
+        }
+    }
 }
 
-std::pair<std::forward_list<MessagingNode>, std::forward_list<MessagingNode>> scan_modules(std::forward_list<std::unique_ptr<Module>>& modules, int thread_no) {
-    // TODO: do parallelism in this function
-    std::forward_list<MessagingNode> sends {}, func_send;
-    std::forward_list<MessagingNode> recvs {}, func_recv;
 
-    
+/**
+ Find all send and recv calls in a module.
+
+ @param module The module to scan.
+ @param release_unused Drop lazily loaded bodies again that contain no send or recv.
+ @param all_instructions Visit every instruction instead of only the users of send/recv functions.
+ @param track_channels Find the channel of every send and recv through the channel creation sites.
+ @param store Receives the send and recv nodes of the module.
+ */
+void scan_module(std::unique_ptr<Module>& module, bool release_unused, bool all_instructions, bool track_channels, NodeStore& store) {
+    NodeId first_node = static_cast<NodeId>(store.size());
+
+    if (!module->isMaterialized()) {
+        // lazily loaded modules without any channel function cannot contain a send or recv call.
+        // Skip them before a single function body gets materialized.
+        if (!hasChannelFunctions(module))
+            return;
+
+        // the channels are followed through all functions, so every body is needed
+        if (track_channels) {
+            if (Error e = module->materializeAll()) {
+                logAllUnhandledErrors(std::move(e), errs(), "[ERROR] Couldn't materialize `" + module->getModuleIdentifier() + "`: ");
+                return;
+            }
+        }
+    }
 
-    for (std::unique_ptr<Module>& mod: modules) {
-        std::tie(func_send, func_recv) = scan_module(mod);
-        sends.splice_after(sends.cbefore_begin(), func_send);
-        recvs.splice_after(recvs.cbefore_begin(), func_recv);
+    if (!module->isMaterialized()) {
+        // the users of a function are only known for materialized bodies, so lazily loaded
+        // modules are scanned (and materialized) function by function
+        scan_instructions(module, release_unused, store);
     }
+    else if (all_instructions)
+        scan_instructions(module, release_unused, store);
+    else
+        scan_call_sites(module, store);
 
-    return std::make_pair(sends, recvs);
+    if (track_channels)
+        resolveChannels(*module, store, first_node);
 }
 
+void scan_modules(std::forward_list<std::unique_ptr<Module>>& modules, int thread_no, bool release_unused, bool all_instructions, bool track_channels, NodeStore& store) {
+    // TODO: do parallelism in this function
+    for (std::unique_ptr<Module>& mod: modules)
+        scan_module(mod, release_unused, all_instructions, track_channels, store);
+}
@@ -3,6 +3,7 @@
 
 #include <tuple>
 #include <forward_list>
+#include <unordered_map>
 #include <unordered_set>
 #include <stack>
 #include <string>
@@ -24,10 +25,14 @@
 #include "llvm/Demangle/Demangle.h"
 
 #include "types.hpp"
+#include "nodestore.hpp"
 #include "properties.hpp"
+#include "loader.hpp"
+#include "channeltracking.hpp"
 
 
 // function definitions
-std::pair<std::forward_list<MessagingNode>, std::forward_list<MessagingNode>> scan_modules(std::forward_list<std::unique_ptr<llvm::Module>>& modules, int thread_no);
+void scan_module(std::unique_ptr<llvm::Module>& module, bool release_unused, bool all_instructions, bool track_channels, NodeStore& store);
+void scan_modules(std::forward_list<std::unique_ptr<llvm::Module>>& modules, int thread_no, bool release_unused, bool all_instructions, bool track_channels, NodeStore& store);
 
 #endif /* scanner_hpp */
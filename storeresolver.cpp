@@ -0,0 +1,142 @@
+#include "storeresolver.hpp"
+
+using namespace llvm;
+
+
+/**
+ Build the alias analysis and MemorySSA of a function.
+
+ @param fn The function, its body has to be materialized.
+ */
+StoreResolver::StoreResolver(Function& fn) :
+    layout(fn.getParent()->getDataLayout()),
+    library_info_impl(Triple(fn.getParent()->getTargetTriple())),
+    library_info(library_info_impl),
+    assumptions(fn),
+    dominators(fn),
+    basic_aa(layout, library_info, assumptions, &dominators),
+    aa(library_info) {
+    aa.addAAResult(basic_aa);
+    mssa.reset(new MemorySSA(fn, &aa, &dominators));
+}
+
+
+/**
+ Get the set of values a sent message may have. For a message passed by reference, these are the
+ values of the stores (to the start of the message) that reach the send.
+
+ @param send The send instruction.
+ @param message The message argument of the send.
+ @param meter The budget, every access and value looked at is a step.
+ @return The values, `top` if any of them is unknown.
+ */
+ValueSet StoreResolver::valuesOf(Instruction* send, Value* message, BudgetMeter& meter) {
+    if (!message->getType()->isPointerTy())
+        return resolveValue(message, meter);
+
+    MemoryUseOrDef* access = mssa->getMemoryAccess(send);
+    if (!access)
+        return ValueSet {{}, true};
+    return resolveMemory(message, access->getDefiningAccess(), meter);
+}
+
+
+// both pointers address the same byte of the same object
+bool StoreResolver::isSameSlot(const Value* a, const Value* b) const {
+    APInt offset_a(layout.getPointerTypeSizeInBits(a->getType()), 0);
+    APInt offset_b(layout.getPointerTypeSizeInBits(b->getType()), 0);
+    const Value* base_a = a->stripAndAccumulateInBoundsConstantOffsets(layout, offset_a);
+    const Value* base_b = b->stripAndAccumulateInBoundsConstantOffsets(layout, offset_b);
+    return base_a == base_b && offset_a == offset_b;
+}
+
+
+/**
+ Get the values a (stored) value may have: constants, loads of memory and PHIs, selects and
+ integer casts of them.
+ */
+ValueSet StoreResolver::resolveValue(Value* value, BudgetMeter& meter) {
+    if (ConstantInt* constant = dyn_cast<ConstantInt>(value)) {
+        if (constant->getBitWidth() <= 64)
+            return ValueSet {{constant->getSExtValue()}, false};
+        return ValueSet {{}, true};
+    }
+
+    BudgetScope scope(meter);
+    if (!scope)
+        return ValueSet {{}, true};
+
+    // a cycle of PHIs adds nothing new
+    std::pair<const void*, const Value*> key = std::make_pair(nullptr, value);
+    if (!visiting.insert(key).second)
+        return ValueSet {{}, false};
+
+    ValueSet values {{}, true};
+    if (LoadInst* load = dyn_cast<LoadInst>(value)) {
+        MemoryUseOrDef* access = mssa->getMemoryAccess(load);
+        if (access)
+            values = resolveMemory(load->getPointerOperand(), access->getDefiningAccess(), meter);
+    }
+    else if (PHINode* phi = dyn_cast<PHINode>(value)) {
+        values = ValueSet {{}, false};
+        for (Value* incoming: phi->incoming_values())
+            values.join(resolveValue(incoming, meter));
+    }
+    else if (SelectInst* select = dyn_cast<SelectInst>(value)) {
+        values = resolveValue(select->getTrueValue(), meter);
+        values.join(resolveValue(select->getFalseValue(), meter));
+    }
+    else if (isa<ZExtInst>(value) || isa<SExtInst>(value) || isa<TruncInst>(value))
+        values = resolveValue(cast<Instruction>(value)->getOperand(0), meter);
+
+    visiting.erase(key);
+    return values;
+}
+
+
+/**
+ Get the values the memory a pointer points to may hold, as written by the stores that reach
+ an access.
+
+ @param ptr The pointer, only its first byte is looked at (where the discriminant of an enum is).
+ @param start The access to start the search at, the defining access of the reading instruction.
+ @param meter The budget.
+ @return The values, `top` if a clobber other than a store or memcpy of the slot reaches the access.
+ */
+ValueSet StoreResolver::resolveMemory(Value* ptr, MemoryAccess* start, BudgetMeter& meter) {
+    BudgetScope scope(meter);
+    if (!scope)
+        return ValueSet {{}, true};
+
+    MemoryAccess* clobber = mssa->getWalker()->getClobberingMemoryAccess(start, MemoryLocation(ptr, 1));
+    // the memory comes from the caller
+    if (mssa->isLiveOnEntryDef(clobber))
+        return ValueSet {{}, true};
+
+    // a loop of memory adds nothing new
+    std::pair<const void*, const Value*> key = std::make_pair(static_cast<const void*>(clobber), ptr);
+    if (!visiting.insert(key).second)
+        return ValueSet {{}, false};
+
+    ValueSet values {{}, true};
+    if (MemoryPhi* phi = dyn_cast<MemoryPhi>(clobber)) {
+        values = ValueSet {{}, false};
+        for (unsigned idx = 0; idx < phi->getNumIncomingValues() && !values.top; ++idx)
+            values.join(resolveMemory(ptr, phi->getIncomingValue(idx), meter));
+    }
+    else if (MemoryDef* def = dyn_cast<MemoryDef>(clobber)) {
+        Instruction* inst = def->getMemoryInst();
+        // anything but a store to exactly the message (or a copy of it) makes it unknown
+        if (StoreInst* store = dyn_cast<StoreInst>(inst)) {
+            if (isSameSlot(store->getPointerOperand(), ptr))
+                values = resolveValue(store->getValueOperand(), meter);
+        }
+        else if (MemTransferInst* copy = dyn_cast<MemTransferInst>(inst)) {
+            if (isSameSlot(copy->getRawDest(), ptr))
+                values = resolveMemory(copy->getRawSource(), def->getDefiningAccess(), meter);
+        }
+    }
+
+    visiting.erase(key);
+    return values;
+}
@@ -0,0 +1,61 @@
+#ifndef storeresolver_hpp
+#define storeresolver_hpp
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <utility>
+
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/MemoryLocation.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Transforms/Utils/MemorySSA.h"
+
+#include "budget.hpp"
+#include "dataflow.hpp"
+
+
+/**
+ Finds the stores that reach a send with MemorySSA and basic alias analysis, built once per
+ function. Starting at the send, the walker skips every store and call that cannot write to the
+ message, so only the stores actually reaching the send are looked at, through memcpys (moves of
+ the message), PHIs of memory and the loads, PHIs and selects of stored values.
+
+ The assumption cache of the alias analysis registers value handles in the LLVMContext of the
+ function, resolvers of functions sharing a context must be built, used and destroyed by one thread.
+ */
+class StoreResolver {
+public:
+    explicit StoreResolver(llvm::Function& fn);
+
+    ValueSet valuesOf(llvm::Instruction* send, llvm::Value* message, BudgetMeter& meter);
+
+private:
+    const llvm::DataLayout& layout;
+    llvm::TargetLibraryInfoImpl library_info_impl;
+    llvm::TargetLibraryInfo library_info;
+    llvm::AssumptionCache assumptions;
+    llvm::DominatorTree dominators;
+    llvm::BasicAAResult basic_aa;
+    llvm::AAResults aa;
+    std::unique_ptr<llvm::MemorySSA> mssa;
+    std::set<std::pair<const void*, const llvm::Value*>> visiting;   ///< The accesses and values being resolved, to stop at cycles.
+
+    bool isSameSlot(const llvm::Value* a, const llvm::Value* b) const;
+    ValueSet resolveValue(llvm::Value* value, BudgetMeter& meter);
+    ValueSet resolveMemory(llvm::Value* ptr, llvm::MemoryAccess* start, BudgetMeter& meter);
+};
+
+#endif /* storeresolver_hpp */
@@ -0,0 +1,180 @@
+#include "summary.hpp"
+
+using namespace llvm;
+
+
+namespace {
+
+/// A function on the way through the call graph.
+struct CallNode {
+    unsigned index;                                 ///< The order the function was found in.
+    unsigned lowlink;                               ///< The smallest index reachable from it on the stack.
+    std::vector<Function*> callees;
+    std::vector<const Instruction*> sends;
+    std::size_t next;                               ///< The next callee to follow.
+};
+
+}
+
+
+// the functions called by a function and its sends, a send is not followed into
+static void collectCalls(Function* fn, CallNode& node) {
+    // functions defined in other modules have no calls we could know of
+    if (!ensureMaterialized(fn) || fn->isDeclaration())
+        return;
+
+    std::unordered_set<Function*> callees {};
+    for (BasicBlock& bb: fn->getBasicBlockList())
+        for (Instruction& inst: bb.getInstList()) {
+            Function* callee = nullptr;
+            if (CallInst* ci = dyn_cast<CallInst>(&inst)) {
+                if (isSend(ci)) {
+                    node.sends.push_back(ci);
+                    continue;
+                }
+                callee = ci->getCalledFunction();
+            }
+            else if (InvokeInst* ii = dyn_cast<InvokeInst>(&inst)) {
+                if (isSend(ii)) {
+                    node.sends.push_back(ii);
+                    continue;
+                }
+                callee = ii->getCalledFunction();
+            }
+
+            if (callee && callees.insert(callee).second)
+                node.callees.push_back(callee);
+        }
+}
+
+
+/**
+ Summarize a function and every function it can call that has not been summarized yet, with
+ Tarjan's algorithm (without recursion, call chains can be deep).
+
+ @param fn The function.
+ */
+void SendSummaries::summarize(Function* fn) {
+    if (function_components.find(fn) != function_components.end())
+        return;
+
+    std::unordered_map<Function*, CallNode> nodes {};
+    std::vector<Function*> stack {};
+    std::vector<Function*> path {};
+
+    auto open = [&](Function* function) {
+        CallNode& node = nodes[function];
+        node.index = node.lowlink = static_cast<unsigned>(nodes.size() - 1);
+        node.next = 0;
+        collectCalls(function, node);
+        stack.push_back(function);
+        path.push_back(function);
+    };
+
+    open(fn);
+    while (!path.empty()) {
+        CallNode& node = nodes.at(path.back());
+        if (node.next < node.callees.size()) {
+            Function* callee = node.callees[node.next++];
+            // summarized callees (from before or in a finished component) are no longer on the stack
+            if (function_components.find(callee) != function_components.end())
+                continue;
+
+            auto known = nodes.find(callee);
+            if (known == nodes.end())
+                open(callee);
+            else
+                node.lowlink = std::min(node.lowlink, known->second.index);
+            continue;
+        }
+
+        Function* function = path.back();
+        path.pop_back();
+        if (!path.empty()) {
+            CallNode& caller = nodes.at(path.back());
+            caller.lowlink = std::min(caller.lowlink, node.lowlink);
+        }
+        if (node.lowlink != node.index)
+            continue;
+
+        // `function` is the root of a component, its members are on top of the stack
+        std::size_t component_id = components.size();
+        std::vector<Function*> members {};
+        do {
+            members.push_back(stack.back());
+            stack.pop_back();
+            function_components[members.back()] = component_id;
+        } while (members.back() != function);
+
+        Component component {{}, {}, false};
+        for (Function* member: members) {
+            const CallNode& member_node = nodes.at(member);
+            component.sends.insert(component.sends.end(), member_node.sends.begin(), member_node.sends.end());
+            for (Function* callee: member_node.callees) {
+                std::size_t callee_id = function_components.at(callee);
+                if (callee_id != component_id)
+                    component.callees.push_back(callee_id);
+            }
+        }
+
+        std::sort(component.callees.begin(), component.callees.end());
+        component.callees.erase(std::unique(component.callees.begin(), component.callees.end()), component.callees.end());
+        component.reaches_send = !component.sends.empty();
+        for (std::size_t callee_id: component.callees)
+            component.reaches_send = component.reaches_send || components[callee_id].reaches_send;
+
+        components.push_back(std::move(component));
+    }
+}
+
+
+/**
+ Check whether a function can reach a send, i.e. whether a traversal has to enter it.
+
+ @param fn The function.
+ @return `true`, if the function or a function it calls sends, or if it has not been summarized.
+ */
+bool SendSummaries::reachesSend(const Function* fn) const {
+    auto component = function_components.find(fn);
+    return component == function_components.end() || components[component->second].reaches_send;
+}
+
+
+/**
+ Get the sends a function can reach, its own and those of every function it calls.
+
+ @param fn The function, it has to be summarized.
+ @return The sends, in no particular order.
+ */
+std::vector<const Instruction*> SendSummaries::sendsOf(const Function* fn) const {
+    std::vector<const Instruction*> sends {};
+    auto start = function_components.find(fn);
+    if (start == function_components.end())
+        return sends;
+
+    // the components form a DAG, the sends of each are added once
+    std::vector<bool> seen(components.size(), false);
+    std::vector<std::size_t> unvisited {start->second};
+    seen[start->second] = true;
+    while (!unvisited.empty()) {
+        const Component& component = components[unvisited.back()];
+        unvisited.pop_back();
+        if (!component.reaches_send)
+            continue;
+
+        sends.insert(sends.end(), component.sends.begin(), component.sends.end());
+        for (std::size_t callee_id: component.callees)
+            if (!seen[callee_id]) {
+                seen[callee_id] = true;
+                unvisited.push_back(callee_id);
+            }
+    }
+
+    return sends;
+}
+
+
+/// The number of summarized functions.
+std::size_t SendSummaries::size() const {
+    return function_components.size();
+}
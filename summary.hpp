@@ -0,0 +1,47 @@
+#ifndef summary_hpp
+#define summary_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Casting.h"
+
+#include "properties.hpp"
+#include "loader.hpp"
+
+
+/**
+ Summaries of the call graph for the guided analysis: whether a function can reach a send,
+ directly or through the functions it calls, and which sends these are. The call graph (of direct
+ calls) is condensed into its strongly connected components, all functions of a component share
+ their summary. Every function is summarized once, the summaries are reused by every traversal.
+
+ Summarizing reads the bodies of lazily loaded functions and is not thread-safe, looking up the
+ summaries is.
+ */
+class SendSummaries {
+public:
+    void summarize(llvm::Function* fn);
+
+    bool reachesSend(const llvm::Function* fn) const;
+    std::vector<const llvm::Instruction*> sendsOf(const llvm::Function* fn) const;
+    std::size_t size() const;
+
+private:
+    struct Component {
+        std::vector<const llvm::Instruction*> sends;    ///< The sends in the functions of the component.
+        std::vector<std::size_t> callees;               ///< The components called, all summarized before this one.
+        bool reaches_send;
+    };
+
+    std::unordered_map<const llvm::Function*, std::size_t> function_components;
+    std::vector<Component> components;
+};
+
+#endif /* summary_hpp */
@@ -6,8 +6,13 @@
 #include <unordered_set>
 #include <forward_list>
 #include <map>
+#include <vector>
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/IR/Instructions.h"
 
+#include "interner.hpp"
+
 enum UsageType {
     Unchecked,                  ///< This node was not checked.
     DirectUse,                  ///< The received value is being used directly in the function, no unwrap involved.
@@ -18,19 +23,33 @@ enum UsageType {
 };
 
 struct MessagingNode {
-    llvm::Instruction* instr;
-    std::string type;
-    std::string nspace;
+    llvm::Instruction* instr;   ///< The send/recv call. `nullptr` if the node was restored from the analysis cache.
+    StringId type;              ///< The message type, interned.
+    StringId nspace;            ///< The source file (or module) of the call, interned.
+    unsigned line;              ///< Source line of the call, 0 if no debug information is available.
+    llvm::StringRef function;   ///< Name of the function containing the call. Points into the arena of the `NodeStore`.
+    StringId channel;           ///< The creation site (`namespace:line`) of the channel, interned. `NoChannel` if unknown.
+    bool inconclusive;          ///< The analysis of the node ran out of its budget, its assignment/usage is incomplete.
+    llvm::ArrayRef<long long> assignments;  ///< Sends: every value the message may have, sorted. Points into the arena of the `NodeStore`.
     union {
-        long long assignment;
+        long long assignment;   ///< Sends: the value of the message if there is exactly one, -1 otherwise.
         std::pair<UsageType, llvm::Instruction*> usage;
     };
 
 };
 
-typedef std::unordered_map<std::string, std::forward_list<std::pair<MessagingNode*, MessagingNode*>>> MessageMap;
+/// Stable index of a node in the `NodeStore`.
+typedef unsigned NodeId;
+
+/// A matched sender/receiver pair, (send, recv).
+typedef std::pair<NodeId, NodeId> NodePair;
+
+typedef std::unordered_map<StringId, std::vector<NodePair>> MessageMap;
+
+/// The matched pairs of each send instruction.
+typedef std::unordered_map<const llvm::Instruction*, std::vector<NodePair>> SendIndex;
 
-typedef std::unordered_map<std::string, std::map<long, std::unordered_set<MessagingNode*>>> NodeMap;
+typedef std::unordered_map<StringId, std::map<long, std::unordered_set<NodeId>>> NodeMap;
 
 
 
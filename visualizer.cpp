@@ -2,31 +2,38 @@
 
 using namespace llvm;
 
-std::hash<std::string> hash_fn;
-std::hash<Instruction*> hash_inst;
+/**
+ Group the matched pairs by the namespace of their send.
 
-MessageMap buildMessageMap(const std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* node_pairs) {
+ @param store The nodes of the pairs.
+ @param node_pairs The matched pairs.
+ @param send_index Receives the pairs of every send instruction as well, if not `nullptr`.
+ @return The pairs by namespace, every namespace with a receiver has an entry.
+ */
+MessageMap buildMessageMap(const NodeStore& store, const std::vector<NodePair>* node_pairs, SendIndex* send_index) {
     MessageMap mmap = MessageMap();
 
-    for (std::pair<MessagingNode*, MessagingNode*> pair: *node_pairs) {
-        mmap[pair.first->nspace].push_front(pair);
+    for (NodePair pair: *node_pairs) {
+        mmap[store[pair.first].nspace].push_back(pair);
+        if (send_index)
+            (*send_index)[store[pair.first].instr].push_back(pair);
 
         // if a node is never sending anything and just receiving, we risk having no information about it in the graph
         //  -> therefore, for every receiver an empty node is inserted
-        if (mmap.find(pair.second->nspace) == mmap.end())
-            mmap.insert(std::make_pair(pair.second->nspace, std::forward_list<std::pair<MessagingNode*, MessagingNode*>>::forward_list()));
+        if (mmap.find(store[pair.second].nspace) == mmap.end())
+            mmap.insert(std::make_pair(store[pair.second].nspace, std::vector<NodePair>()));
     }
 
     return mmap;
 }
 
 
-NodeMap buildNodeMap(const std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* node_pairs) {
+NodeMap buildNodeMap(const NodeStore& store, const std::vector<NodePair>* node_pairs) {
     NodeMap nmap = NodeMap();
 
-    for (std::pair<MessagingNode*, MessagingNode*> pair: *node_pairs) {
-        nmap[pair.first->nspace][pair.first->instr->getDebugLoc()->getLine()].insert(pair.first);
-        nmap[pair.second->nspace][pair.second->instr->getDebugLoc()->getLine()].insert(pair.second);
+    for (NodePair pair: *node_pairs) {
+        nmap[store[pair.first].nspace][store[pair.first].line].insert(pair.first);
+        nmap[store[pair.second].nspace][store[pair.second].line].insert(pair.second);
     }
 
     return nmap;
@@ -34,25 +41,25 @@ NodeMap buildNodeMap(const std::forward_list<std::pair<MessagingNode*, Messaging
 
 
 /**
- Generate the internal name of a node in the graph by hashing its description.
+ Generate the internal name of a node in the graph from its interned description.
 
- @param verbose_name The verbose node name.
- @return The hashed node name following the scheme "Node<hash>".
+ @param nspace The interned namespace the node stands for.
+ @return The node name following the scheme "Node<id>".
  */
-std::string getNodeName (std::string verbose_name) {
+std::string getNodeName (StringId nspace) {
     std::string nodename = "Node";
-    nodename.append(std::to_string(hash_fn(verbose_name)));
+    nodename.append(std::to_string(nspace));
     return nodename;
 }
 
 
-void visualize(const std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* node_pairs, std::string output_path) {
+void visualize(const NodeStore& store, const std::vector<NodePair>* node_pairs, std::string output_path) {
     if (node_pairs == nullptr)
         return;
     
     // generate Message and node maps that contain information about the nodes and the messages exchanged
-    MessageMap mmap = buildMessageMap(node_pairs);
-    NodeMap nmap = buildNodeMap(node_pairs);
+    MessageMap mmap = buildMessageMap(store, node_pairs);
+    NodeMap nmap = buildNodeMap(store, node_pairs);
 
     std::ofstream graph_file(output_path.c_str());
     if (graph_file.good()) {
@@ -66,32 +73,36 @@ void visualize(const std::forward_list<std::pair<MessagingNode*, MessagingNode*>
         << "node [shape=record];" << std::endl << std::endl;
 
         // first, print the node definitions
-        for (std::pair<std::string, std::map<long, std::unordered_set<MessagingNode*>>> item: nmap) {
+        for (const std::pair<const StringId, std::map<long, std::unordered_set<NodeId>>>& item: nmap) {
             std::string nodename = getNodeName(item.first);
 
             // graph_file << "\t" << nodename << " [shape=box,label=\"" << item.first << "\"]" << std::endl;
 
             // first emit node name, then send/recv nodes
             graph_file << "\t" << nodename \
-                       << " [label=\"" << item.first;
-            for (std::pair<long, std::unordered_set<MessagingNode*>> node: item.second)
-                for (MessagingNode* instruction: node.second)
-                    graph_file << "|<" << std::to_string(hash_inst(instruction->instr)) \
+                       << " [label=\"" << internedString(item.first).str();
+            // the node IDs are unique, so they serve as port names
+            for (const std::pair<const long, std::unordered_set<NodeId>>& node: item.second)
+                for (NodeId instruction: node.second)
+                    graph_file << "|<" << std::to_string(instruction) \
                                << "> Line: " << node.first; // TODO: More info here?
             graph_file << "\"]" << std::endl;
         }
 
-        for (std::pair<std::string, std::forward_list<std::pair<MessagingNode*, MessagingNode*>>> item: mmap) {
+        for (const std::pair<const StringId, std::vector<NodePair>>& item: mmap) {
             std::string nodename = getNodeName(item.first);
 
-            for (std::pair<MessagingNode*, MessagingNode*> connection: item.second) {
-                graph_file << "\t" << nodename << ":" << std::to_string(hash_inst(connection.first->instr)) \
-                    << " -> " << getNodeName(connection.second->nspace) << ":" << std::to_string(hash_inst(connection.second->instr)) \
-                    << " [label = \"" << connection.first->type;
+            for (NodePair connection: item.second) {
+                const MessagingNode& send = store[connection.first];
+                graph_file << "\t" << nodename << ":" << std::to_string(connection.first) \
+                    << " -> " << getNodeName(store[connection.second].nspace) << ":" << std::to_string(connection.second) \
+                    << " [label = \"" << internedString(send.type).str();
 
                 // add info about sent data (if available)
-                if (connection.first->assignment != -1)
-                    graph_file << ": " << connection.first->assignment;
+                for (std::size_t value = 0; value < send.assignments.size(); ++value)
+                    graph_file << (value == 0 ? ": " : ", ") << send.assignments[value];
+                if (send.assignments.empty() && send.inconclusive)
+                    graph_file << ": ?";
 
                 // graph_file << "\\n Receive at: " << connection.second->instr->getDebugLoc()->getLine();
                 // if (connection.second->usage.first != Unchecked && connection.second->usage.first != DirectUse)
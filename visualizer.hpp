@@ -1,7 +1,7 @@
 #ifndef visualizer_hpp
 #define visualizer_hpp
 
-#include <forward_list>
+#include <vector>
 #include <iostream>
 #include <fstream>
 
@@ -12,9 +12,10 @@
 #include "llvm/IR/DebugInfoMetadata.h"
 
 #include "types.hpp"
+#include "nodestore.hpp"
 
 // Function definitions
-MessageMap buildMessageMap(const std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* node_pairs);
-void visualize(const std::forward_list<std::pair<MessagingNode*, MessagingNode*>>* node_pairs, std::string output_path);
+MessageMap buildMessageMap(const NodeStore& store, const std::vector<NodePair>* node_pairs, SendIndex* send_index = nullptr);
+void visualize(const NodeStore& store, const std::vector<NodePair>* node_pairs, std::string output_path);
 
 #endif /* visualizer_hpp */